@@ -171,8 +171,9 @@ void ConfigModel::appendConfiguration(const QString &key,
         internalItem.kitValue = QString::fromUtf8(
             isInitial ? m_kitConfiguration.value(key).value
                       : m_kitConfiguration.value(key).expandedValue(m_macroExpander).toUtf8());
-    m_configuration.append(internalItem);
-    setConfiguration(m_configuration);
+    QList<InternalDataItem> configuration = m_configuration;
+    configuration.append(internalItem);
+    setConfiguration(configuration);
 }
 
 void ConfigModel::setConfiguration(const QList<DataItem> &config)
@@ -183,10 +184,11 @@ void ConfigModel::setConfiguration(const QList<DataItem> &config)
 void ConfigModel::setConfigurationFromKit(const KitConfiguration &kitConfig)
 {
     m_kitConfiguration = kitConfig;
+    QList<InternalDataItem> configuration = m_configuration;
     QHash<QString, InternalDataItem> initialConfig;
 
     // Update the kit values for initial configuration keys
-    for (InternalDataItem &i : m_configuration) {
+    for (InternalDataItem &i : configuration) {
         if (!i.isInitial)
             continue;
         if (m_kitConfiguration.contains(i.key))
@@ -202,20 +204,20 @@ void ConfigModel::setConfigurationFromKit(const KitConfiguration &kitConfig)
             i.isInitial = true;
             i.newValue = i.value;
             i.kitValue = i.value;
-            m_configuration.append(i);
+            configuration.append(i);
         }
     }
 
     // Remove kit values when the kit's keys are removed
     for (const auto &i : initialConfig) {
         if (!kitConfig.contains(i.key)) {
-            auto existing = std::find(m_configuration.begin(), m_configuration.end(), i);
-            if (existing != m_configuration.end())
+            auto existing = std::find(configuration.begin(), configuration.end(), i);
+            if (existing != configuration.end())
                 existing->kitValue.clear();
         }
     }
 
-    setConfiguration(m_configuration);
+    setConfiguration(configuration);
 }
 
 void ConfigModel::flush()
@@ -381,10 +383,11 @@ void ConfigModel::setConfiguration(const XMakeConfig &config)
 
 void ConfigModel::setBatchEditConfiguration(const XMakeConfig &config)
 {
+    QList<InternalDataItem> configuration = m_configuration;
     for (const auto &c: config) {
         DataItem di(c);
-        auto existing = std::find(m_configuration.begin(), m_configuration.end(), di);
-        if (existing != m_configuration.end()) {
+        auto existing = std::find(configuration.begin(), configuration.end(), di);
+        if (existing != configuration.end()) {
             existing->isUnset = c.isUnset;
             const QString newValue = QString::fromUtf8(c.value);
             // Allow a different value when the user didn't change anything (don't mark the same value as new)
@@ -400,24 +403,25 @@ void ConfigModel::setBatchEditConfiguration(const XMakeConfig &config)
             InternalDataItem i(di);
             i.isUserNew = true;
             i.newValue = di.value;
-            m_configuration.append(i);
+            configuration.append(i);
         }
     }
 
-    generateTree();
+    updateTree(std::move(configuration));
 }
 
 void ConfigModel::setInitialParametersConfiguration(const XMakeConfig &config)
 {
+    QList<InternalDataItem> configuration = m_configuration;
     for (const auto &c: config) {
         DataItem di(c);
         InternalDataItem i(di);
         i.inXMakeCache = true;
         i.isInitial = true;
         i.newValue = di.value;
-        m_configuration.append(i);
+        configuration.append(i);
     }
-    generateTree();
+    updateTree(std::move(configuration));
 }
 
 void ConfigModel::setConfiguration(const QList<ConfigModel::InternalDataItem> &config)
@@ -482,10 +486,10 @@ void ConfigModel::setConfiguration(const QList<ConfigModel::InternalDataItem> &c
     QList<InternalDataItem> currentNew;
     std::tie(initialNew, currentNew) = Utils::partition(config, isInitial);
 
-    m_configuration = mergeLists(initialOld, initialNew);
-    m_configuration.append(mergeLists(currentOld, currentNew));
+    QList<InternalDataItem> configuration = mergeLists(initialOld, initialNew);
+    configuration.append(mergeLists(currentOld, currentNew));
 
-    generateTree();
+    updateTree(std::move(configuration));
 }
 
 Utils::MacroExpander *ConfigModel::macroExpander() const
@@ -498,22 +502,77 @@ void ConfigModel::setMacroExpander(Utils::MacroExpander *newExpander)
     m_macroExpander = newExpander;
 }
 
-void ConfigModel::generateTree()
+// Updates the rows from m_configuration to the new configuration. Rows are matched by key and
+// initial flag, so that views keep their scroll position and selection.
+void ConfigModel::updateTree(QList<InternalDataItem> &&configuration)
 {
-    QHash<QString, InternalDataItem> initialHash;
-    for (const InternalDataItem &di : m_configuration)
+    // The tree items point into the configuration lists. The buffer of configuration is
+    // detached here and kept when it is moved into m_configuration.
+    QHash<QString, QString> initialValues;
+    for (InternalDataItem &di : configuration) {
         if (di.isInitial)
-            initialHash.insert(di.key, di);
+            initialValues.insert(di.key, di.expandedValue(macroExpander()));
+    }
+    for (InternalDataItem &di : configuration) {
+        const auto it = initialValues.constFind(di.key);
+        if (it != initialValues.cend())
+            di.initialValue = *it;
+    }
+
+    if (m_configuration.isEmpty() || configuration.isEmpty()) {
+        auto root = new Utils::TreeItem;
+        for (InternalDataItem &di : configuration)
+            root->appendChild(new Internal::ConfigModelTreeItem(&di));
+        setRootItem(root);
+        m_configuration = std::move(configuration);
+        return;
+    }
 
-    auto root = new Utils::TreeItem;
-    for (InternalDataItem &di : m_configuration) {
-        auto it = initialHash.find(di.key);
-        if (it != initialHash.end())
-            di.initialValue = it->expandedValue(macroExpander());
+    QHash<std::pair<QString, bool>, QList<qsizetype>> newRows;
+    for (qsizetype i = 0; i < configuration.size(); ++i)
+        newRows[{configuration.at(i).key, configuration.at(i).isInitial}].append(i);
+
+    Utils::TreeItem *root = rootItem();
+    QList<int> changedRows;
+    int row = 0;
+    qsizetype next = 0;
+    for (const InternalDataItem &oldItem : std::as_const(m_configuration)) {
+        qsizetype pos = -1;
+        const auto it = newRows.find({oldItem.key, oldItem.isInitial});
+        if (it != newRows.end()) {
+            while (!it->isEmpty() && it->first() < next)
+                it->removeFirst();
+            if (!it->isEmpty())
+                pos = it->takeFirst();
+        }
+
+        if (pos < 0) {
+            root->removeChildAt(row);
+            continue;
+        }
 
-        root->appendChild(new Internal::ConfigModelTreeItem(&di));
+        for (; next < pos; ++next)
+            root->insertChild(row++, new Internal::ConfigModelTreeItem(&configuration[next]));
+
+        auto item = static_cast<Internal::ConfigModelTreeItem *>(root->childAt(row));
+        item->dataItem = &configuration[pos];
+        if (!oldItem.hasSameContent(configuration.at(pos)))
+            changedRows.append(row);
+        ++row;
+        next = pos + 1;
+    }
+    for (; next < configuration.size(); ++next)
+        root->insertChild(row++, new Internal::ConfigModelTreeItem(&configuration[next]));
+
+    m_configuration = std::move(configuration);
+
+    for (qsizetype first = 0; first < changedRows.size();) {
+        qsizetype last = first;
+        while (last + 1 < changedRows.size() && changedRows.at(last + 1) == changedRows.at(last) + 1)
+            ++last;
+        emit dataChanged(index(changedRows.at(first), 0), index(changedRows.at(last), 1));
+        first = last + 1;
     }
-    setRootItem(root);
 }
 
 ConfigModel::InternalDataItem::InternalDataItem(const ConfigModel::DataItem &item) : DataItem(item)
@@ -526,6 +585,17 @@ QString ConfigModel::InternalDataItem::currentValue() const
     return isUserChanged ? newValue : value;
 }
 
+bool ConfigModel::InternalDataItem::hasSameContent(const InternalDataItem &other) const
+{
+    return key == other.key && type == other.type && isHidden == other.isHidden
+           && isAdvanced == other.isAdvanced && isInitial == other.isInitial
+           && inXMakeCache == other.inXMakeCache && isUnset == other.isUnset
+           && value == other.value && description == other.description
+           && values == other.values && isUserChanged == other.isUserChanged
+           && isUserNew == other.isUserNew && newValue == other.newValue
+           && kitValue == other.kitValue && initialValue == other.initialValue;
+}
+
 
 ConfigModelTreeItem::~ConfigModelTreeItem() = default;
 
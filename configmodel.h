@@ -99,6 +99,7 @@ public:
             InternalDataItem(const DataItem &item);
 
             QString currentValue() const;
+            bool hasSameContent(const InternalDataItem &other) const;
 
             bool isUserChanged = false;
             bool isUserNew = false;
@@ -107,9 +108,11 @@ public:
             QString initialValue;
         };
 
-        void generateTree();
+        void updateTree(QList<InternalDataItem> &&configuration);
 
         void setConfiguration(const QList<InternalDataItem> &config);
+        // The tree items point into this list. It is only replaced as a whole by updateTree()
+        // and setConfiguration(), and must not detach or reallocate otherwise.
         QList<InternalDataItem> m_configuration;
         KitConfiguration m_kitConfiguration;
         Utils::MacroExpander *m_macroExpander = nullptr;
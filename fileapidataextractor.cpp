@@ -387,6 +387,11 @@ public:
             }
         }
 
+        QHash<QString, QString> targetNames;
+        for (const TargetDetails &t : input.targetDetails) {
+            targetNames.insert(t.id, t.name);
+        }
+
         QList<XMakeBuildTarget> result;
         result.reserve(input.targetDetails.size());
         for (const TargetDetails &t : input.targetDetails) {
@@ -394,7 +399,15 @@ public:
                 return {};
             }
 
-            result.append(toBuildTarget(t, sourceDirectory, buildDirectory, relativeLibs, artifacts));
+            XMakeBuildTarget ct = toBuildTarget(t, sourceDirectory, buildDirectory, relativeLibs,
+                                                artifacts);
+            for (const DependencyInfo &d : t.dependencies) {
+                const QString name = targetNames.value(d.targetId);
+                if (!name.isEmpty()) {
+                    ct.dependencies.append(name);
+                }
+            }
+            result.append(std::move(ct));
         }
         return result;
     }
@@ -190,28 +190,14 @@ XMakeTargetNode *createTargetNode(const QHash<Utils::FilePath, ProjectNode *> &x
     return tn;
 }
 
-template<typename Result>
-static std::unique_ptr<Result> cloneFolderNode(FolderNode *node)
-{
-    auto folderNode = std::make_unique<Result>(node->filePath());
-    folderNode->setDisplayName(node->displayName());
-    for (Node *node : node->nodes()) {
-        if (FileNode *fn = node->asFileNode()) {
-            folderNode->addNode(std::unique_ptr<FileNode>(fn->clone()));
-        } else if (FolderNode *fn = node->asFolderNode()) {
-            folderNode->addNode(cloneFolderNode<FolderNode>(fn));
-        } else {
-            QTC_CHECK(false);
-        }
-    }
-    return folderNode;
-}
-
-void addFileSystemNodes(ProjectNode *root, const std::shared_ptr<FolderNode> &folderNode)
+void addFileSystemNodes(ProjectNode *root,
+                        const Utils::FilePath &baseDirectory,
+                        std::vector<std::unique_ptr<FileNode>> &&files)
 {
     QTC_ASSERT(root, return );
 
-    auto fileSystemNode = cloneFolderNode<VirtualFolderNode>(folderNode.get());
+    auto fileSystemNode = std::make_unique<VirtualFolderNode>(baseDirectory);
+    fileSystemNode->addNestedNodes(std::move(files), baseDirectory);
     // just before special nodes like "XMake Modules"
     fileSystemNode->setPriority(Node::DefaultPriority - 6);
     fileSystemNode->setDisplayName(Tr::tr("<File System>"));
@@ -49,6 +49,7 @@ XMakeTargetNode *createTargetNode(
     const QString &displayName);
 
 void addFileSystemNodes(ProjectExplorer::ProjectNode *root,
-                        const std::shared_ptr<ProjectExplorer::FolderNode> &folderNode);
+                        const Utils::FilePath &baseDirectory,
+                        std::vector<std::unique_ptr<ProjectExplorer::FileNode>> &&files);
 
 } // XMakeProjectManager::Internal
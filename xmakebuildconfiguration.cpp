@@ -1639,7 +1639,7 @@ private:
         return cxxFlagsInit.contains(QT_QML_DEBUG_PARAM) && cxxFlags.contains(QT_QML_DEBUG_PARAM);
     }
 
-    void XMakeBuildConfiguration::buildTarget(const QString &buildTarget) {
+    void XMakeBuildConfiguration::buildTargets(const QStringList &buildTargets) {
         auto cmBs = qobject_cast<XMakeBuildStep *>(findOrDefault(
             buildSteps()->steps(),
             [](const BuildStep *bs) {
@@ -1649,7 +1649,7 @@ private:
         QStringList originalBuildTargets;
         if (cmBs) {
             originalBuildTargets = cmBs->buildTargets();
-            cmBs->setBuildTargets({ buildTarget });
+            cmBs->setBuildTargets(buildTargets);
         }
 
         BuildManager::buildList(buildSteps());
@@ -1659,7 +1659,7 @@ private:
         }
     }
 
-    XMakeConfig XMakeBuildSystem::configurationFromXMake() const {
+    const IndexedXMakeConfig &XMakeBuildSystem::configurationFromXMake() const {
         return m_configurationFromXMake;
     }
 
@@ -58,7 +58,7 @@ public:
         static bool hasQmlDebugging(const XMakeConfig &config);
 
         // Context menu action:
-        void buildTarget(const QString &buildTarget);
+        void buildTargets(const QStringList &buildTargets);
         ProjectExplorer::BuildSystem *buildSystem() const final;
 
         void addToEnvironment(Utils::Environment &env) const override;
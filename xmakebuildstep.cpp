@@ -21,7 +21,9 @@
 
 #include <webassembly/webassemblyconstants.h>
 
+#include <coreplugin/documentmanager.h>
 #include <coreplugin/find/itemviewfind.h>
+#include <coreplugin/vcsmanager.h>
 #include <projectexplorer/buildsteplist.h>
 #include <projectexplorer/devicesupport/idevice.h>
 #include <projectexplorer/environmentwidget.h>
@@ -37,14 +39,19 @@
 #include <projectexplorer/xcodebuildparser.h>
 
 #include <utils/algorithm.h>
+#include <utils/fancylineedit.h>
 #include <utils/layoutbuilder.h>
 
+#include <QElapsedTimer>
+#include <QGuiApplication>
 #include <QListWidget>
+#include <QSortFilterProxyModel>
 #include <QRandomGenerator>
-#include <QRegularExpression>
 #include <QTreeView>
 #include <QCheckBox>
 
+#include <limits>
+
 using namespace Core;
 using namespace ProjectExplorer;
 using namespace Tasking;
@@ -57,11 +64,16 @@ const char XMAKE_ARGUMENTS_KEY[] = "XMakeProjectManager.MakeStep.XMakeArguments"
 const char TOOL_ARGUMENTS_KEY[] = "XMakeProjectManager.MakeStep.AdditionalArguments";
 const char USE_STAGING_KEY[] = "XMakeProjectManager.MakeStep.UseStaging";
 const char STAGING_DIR_KEY[] = "XMakeProjectManager.MakeStep.StagingDir";
+const char BUILD_AFFECTED_TARGETS_KEY[] = "XMakeProjectManager.MakeStep.BuildAffectedTargets";
+const char REPORT_SLOWEST_TARGETS_KEY[] = "XMakeProjectManager.MakeStep.ReportSlowestTargets";
 const char IOS_AUTOMATIC_PROVISIONG_UPDATES_ARGUMENTS_KEY[] =
         "XMakeProjectManager.MakeStep.iOSAutomaticProvisioningUpdates";
 const char CLEAR_SYSTEM_ENVIRONMENT_KEY[] = "XMakeProjectManager.MakeStep.ClearSystemEnvironment";
 const char USER_ENVIRONMENT_CHANGES_KEY[] = "XMakeProjectManager.MakeStep.UserEnvironmentChanges";
 const char BUILD_PRESET_KEY[] = "XMakeProjectManager.MakeStep.BuildPreset";
+const char TARGET_DURATIONS_KEY[] = "XMakeProjectManager.MakeStep.TargetDurations";
+
+const qint64 MIN_TARGET_DURATION_MSECS = 100;
 
 class ProjectParserTaskAdapter : public TaskAdapter<QPointer<Target>>
 {
@@ -80,104 +92,283 @@ public:
 
 using ProjectParserTask = CustomTask<ProjectParserTaskAdapter>;
 
+static qsizetype skipSpaces(QStringView text, qsizetype pos)
+{
+    while (pos < text.size() && text.at(pos).isSpace())
+        ++pos;
+    return pos;
+}
+
+// Scans the decimal number at pos. value is -1 if there are no digits or the number overflows.
+static qsizetype scanNumber(QStringView text, qsizetype pos, int *value)
+{
+    const qsizetype start = pos;
+    qint64 result = 0;
+    for (; pos < text.size(); ++pos) {
+        const char16_t c = text.at(pos).unicode();
+        if (c < u'0' || c > u'9')
+            break;
+        if (result <= std::numeric_limits<int>::max())
+            result = result * 10 + (c - u'0');
+    }
+    *value = (pos == start || result > std::numeric_limits<int>::max()) ? -1 : int(result);
+    return pos;
+}
+
+// Returns the name of the target a progress line reports as finished, if any.
+static QStringView finishedTarget(QStringView text, bool useNinja)
+{
+    text = text.trimmed();
+    if (text.startsWith(u':')) // xmake: "[ 42%]: linking.release app"
+        text = text.mid(1).trimmed();
+
+    if (text.startsWith(u"Built target "))
+        return text.mid(13);
+
+    // Make prints "Linking" before "Built target", so only use it for ninja
+    if (text.startsWith(u"linking.") || (useNinja && text.startsWith(u"Linking "))) {
+        QStringView path = text.mid(text.lastIndexOf(u' ') + 1);
+        return path.mid(path.lastIndexOf(u'/') + 1);
+    }
+    return {};
+}
+
+static QString formatDuration(qint64 msecs)
+{
+    const qint64 secs = (msecs + 500) / 1000;
+    return QString("%1:%2").arg(secs / 60).arg(secs % 60, 2, 10, QChar('0'));
+}
+
 class CmakeProgressParser : public Utils::OutputLineParser
 {
     Q_OBJECT
 
+public:
+    // Durations of the targets this build runs from previous builds, used for the
+    // estimated remaining time
+    void setExpectedDurations(const QHash<QString, qint64> &durations)
+    {
+        m_expectedDurations = durations;
+        m_expectedRemaining = 0;
+        for (const qint64 duration : durations)
+            m_expectedRemaining += duration;
+    }
+
 signals:
-    void progress(int percentage);
+    void progress(int percentage, const QString &message);
+    // Only reported for targets that had something to compile or link
+    void targetFinished(const QString &target, qint64 msecs);
 
 private:
+    // Scans "[ 42%]" and "[12/345" by hand, this runs for every line of build output.
     Result handleLine(const QString &line, Utils::OutputFormat format) override
     {
         if (format != Utils::StdOutFormat)
             return Status::NotHandled;
 
-        static const QRegularExpression percentProgress("^\\[\\s*(\\d*)%\\]");
-        static const QRegularExpression ninjaProgress("^\\[\\s*(\\d*)/\\s*(\\d*)");
+        const QStringView text(line);
+        if (!text.startsWith(u'['))
+            return Status::NotHandled;
 
-        QRegularExpressionMatch match = percentProgress.match(line);
-        if (match.hasMatch()) {
-            bool ok = false;
-            const int percent = match.captured(1).toInt(&ok);
-            if (ok)
-                emit progress(percent);
+        int done = -1;
+        qsizetype pos = scanNumber(text, skipSpaces(text, 1), &done);
+        if (pos + 1 < text.size() && text.at(pos) == u'%' && text.at(pos + 1) == u']') {
+            startTiming();
+            handleStatusLine(text.mid(pos + 2));
+            if (done >= 0)
+                reportProgress(done);
             return Status::Done;
         }
-        match = ninjaProgress.match(line);
-        if (match.hasMatch()) {
+        if (pos < text.size() && text.at(pos) == u'/') {
             m_useNinja = true;
-            bool ok = false;
-            const int done = match.captured(1).toInt(&ok);
-            if (ok) {
-                const int all = match.captured(2).toInt(&ok);
-                if (ok && all != 0) {
-                    const int percent = static_cast<int>(100.0 * done / all);
-                    emit progress(percent);
-                }
-            }
+            startTiming();
+            int all = -1;
+            pos = scanNumber(text, skipSpaces(text, pos + 1), &all);
+            const qsizetype statusEnd = text.indexOf(u']', pos);
+            if (statusEnd >= 0)
+                handleStatusLine(text.mid(statusEnd + 1));
+            if (done >= 0 && all > 0)
+                reportProgress(static_cast<int>(100.0 * done / all));
             return Status::Done;
         }
         return Status::NotHandled;
     }
     bool hasDetectedRedirection() const override { return m_useNinja; }
 
+    void startTiming()
+    {
+        if (m_buildTimer.isValid())
+            return;
+        m_buildTimer.start();
+        m_targetTimer.start();
+    }
+
+    // With parallel jobs this is the time since the previous target finished, which adds
+    // up to the wall time of the build rather than to the CPU time of each target.
+    // Up-to-date targets only print the line finishing them and are not reported.
+    void handleStatusLine(QStringView text)
+    {
+        const QStringView target = finishedTarget(text, m_useNinja);
+        if (target.isEmpty()) {
+            m_didWork = true;
+            return;
+        }
+        const QString name = target.toString();
+        m_expectedRemaining -= m_expectedDurations.take(name);
+        const qint64 msecs = m_targetTimer.restart();
+        // A linking line is work itself, make also prints "Built target" for up-to-date targets
+        if (m_didWork || !text.trimmed().startsWith(u"Built target "))
+            emit targetFinished(name, msecs);
+        m_didWork = false;
+    }
+
+    void reportProgress(int percent)
+    {
+        // The progress only counts the work left to do, so it also limits the estimate
+        // from previous builds when most targets are up to date
+        qint64 remaining = -1;
+        if (percent > 0 && percent < 100)
+            remaining = m_buildTimer.elapsed() * (100 - percent) / percent;
+        if (m_expectedRemaining > 0) {
+            const qint64 expected = std::max<qint64>(0, m_expectedRemaining
+                                                            - m_targetTimer.elapsed());
+            remaining = remaining < 0 ? expected : std::min(remaining, expected);
+        }
+
+        emit progress(percent, remaining < 0 ? QString()
+                                             : Tr::tr("About %1 remaining")
+                                                   .arg(formatDuration(remaining)));
+    }
+
     // TODO: Shouldn't we know the backend in advance? Then we could merge this class
     //       with CmakeParser.
     bool m_useNinja = false;
+    bool m_didWork = false;
+
+    QElapsedTimer m_buildTimer;
+    QElapsedTimer m_targetTimer;
+    QHash<QString, qint64> m_expectedDurations;
+    qint64 m_expectedRemaining = 0;
 };
 
 
-// CmakeTargetItem
+// XMakeTargetModel
 
-XMakeTargetItem::XMakeTargetItem(const QString &target, XMakeBuildStep *step, bool special)
-    : m_target(target), m_step(step), m_special(special)
+XMakeTargetModel::XMakeTargetModel(XMakeBuildStep *step)
+    : m_step(step)
 {
 }
 
-QVariant XMakeTargetItem::data(int column, int role) const
+void XMakeTargetModel::setTargets(const QStringList &targets, const QSet<QString> &specialTargets)
 {
-    if (column == 0) {
-        if (role == Qt::DisplayRole) {
-            if (m_target.isEmpty())
-                return Tr::tr("Current executable");
-            return m_target;
+    const bool specialTargetsChanged = specialTargets != m_specialTargets;
+    m_specialTargets = specialTargets;
+
+    if (targets != m_targets) {
+        // Remove the rows of targets that are gone, in runs from the bottom
+        const QSet<QString> newTargets(targets.cbegin(), targets.cend());
+        for (int row = m_targets.size() - 1; row >= 0; --row) {
+            if (newTargets.contains(m_targets.at(row)))
+                continue;
+            int first = row;
+            while (first > 0 && !newTargets.contains(m_targets.at(first - 1)))
+                --first;
+            beginRemoveRows({}, first, row);
+            m_targets.remove(first, row - first + 1);
+            endRemoveRows();
+            row = first;
         }
 
-        if (role == Qt::ToolTipRole) {
-            if (m_target.isEmpty()) {
-                return Tr::tr("Build the executable used in the active run "
-                                          "configuration. Currently: %1")
-                        .arg(m_step->activeRunConfigTarget());
+        // Insert the new targets between the remaining ones
+        const QSet<QString> oldTargets(m_targets.cbegin(), m_targets.cend());
+        int row = 0;
+        for (int i = 0; i < targets.size(); ++i) {
+            if (row < m_targets.size() && m_targets.at(row) == targets.at(i)) {
+                ++row;
+                continue;
+            }
+            if (oldTargets.contains(targets.at(i))) {
+                // The order of the remaining targets changed
+                beginResetModel();
+                m_targets = targets;
+                endResetModel();
+                return;
             }
-            return Tr::tr("Target: %1").arg(m_target);
+            int last = i;
+            while (last + 1 < targets.size() && !oldTargets.contains(targets.at(last + 1)))
+                ++last;
+            beginInsertRows({}, row, row + last - i);
+            for (int j = i; j <= last; ++j)
+                m_targets.insert(row++, targets.at(j));
+            endInsertRows();
+            i = last;
         }
+        QTC_CHECK(m_targets == targets);
+    }
 
-        if (role == Qt::CheckStateRole)
-            return m_step->buildsBuildTarget(m_target) ? Qt::Checked : Qt::Unchecked;
+    if (specialTargetsChanged && !m_targets.isEmpty())
+        emit dataChanged(index(0), index(m_targets.size() - 1), {Qt::FontRole});
+}
 
-        if (role == Qt::FontRole) {
-            if (m_special) {
-                QFont italics;
-                italics.setItalic(true);
-                return italics;
-            }
+void XMakeTargetModel::updateCheckStates()
+{
+    if (!m_targets.isEmpty())
+        emit dataChanged(index(0), index(m_targets.size() - 1), {Qt::CheckStateRole});
+}
+
+int XMakeTargetModel::rowCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : m_targets.size();
+}
+
+QVariant XMakeTargetModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || index.column() != 0 || index.row() >= m_targets.size())
+        return QVariant();
+
+    const QString &target = m_targets.at(index.row());
+
+    if (role == Qt::DisplayRole) {
+        if (target.isEmpty())
+            return Tr::tr("Current executable");
+        return target;
+    }
+
+    if (role == Qt::ToolTipRole) {
+        if (target.isEmpty()) {
+            return Tr::tr("Build the executable used in the active run "
+                                      "configuration. Currently: %1")
+                    .arg(m_step->activeRunConfigTarget());
+        }
+        return Tr::tr("Target: %1").arg(target);
+    }
+
+    if (role == Qt::CheckStateRole)
+        return m_step->buildsBuildTarget(target) ? Qt::Checked : Qt::Unchecked;
+
+    if (role == Qt::FontRole) {
+        if (m_specialTargets.contains(target)) {
+            QFont italics;
+            italics.setItalic(true);
+            return italics;
         }
     }
 
     return QVariant();
 }
 
-bool XMakeTargetItem::setData(int column, const QVariant &data, int role)
+bool XMakeTargetModel::setData(const QModelIndex &index, const QVariant &value, int role)
 {
-    if (column == 0 && role == Qt::CheckStateRole) {
-        m_step->setBuildsBuildTarget(m_target, data.value<Qt::CheckState>() == Qt::Checked);
+    if (index.isValid() && index.column() == 0 && index.row() < m_targets.size()
+        && role == Qt::CheckStateRole) {
+        m_step->setBuildsBuildTarget(m_targets.at(index.row()),
+                                     value.value<Qt::CheckState>() == Qt::Checked);
         return true;
     }
-    return TreeItem::setData(column, data, role);
+    return false;
 }
 
-Qt::ItemFlags XMakeTargetItem::flags(int) const
+Qt::ItemFlags XMakeTargetModel::flags(const QModelIndex &) const
 {
     return Qt::ItemIsUserCheckable | Qt::ItemIsEnabled | Qt::ItemIsSelectable;
 }
@@ -233,6 +424,28 @@ XMakeBuildStep::XMakeBuildStep(BuildStepList *bsl, Id id) :
     stagingDir.setDefaultValue(initialStagingDir(kit()));
     stagingDir.setExpectedKind(PathChooser::Kind::Directory);
 
+    buildAffectedTargetsOnly.setSettingsKey(BUILD_AFFECTED_TARGETS_KEY);
+    buildAffectedTargetsOnly.setLabel(Tr::tr("Build only targets affected by changed files"),
+                                      BoolAspect::LabelPlacement::AtCheckBox);
+    buildAffectedTargetsOnly.setToolTip(
+        Tr::tr("Instead of all targets, builds the targets containing files that changed "
+               "since the last build, and the targets depending on them.<br>"
+               "Only changes saved in %1 are tracked. All targets are built after a change "
+               "to a project file, header or other file that is not a source of a target, "
+               "after a version control operation, after a file changed outside of %1, "
+               "and for the first build of a session.")
+            .arg(QGuiApplication::applicationDisplayName()));
+    buildAffectedTargetsOnly.setDefaultValue(false);
+
+    reportTargetDurations.setSettingsKey(REPORT_SLOWEST_TARGETS_KEY);
+    reportTargetDurations.setLabel(Tr::tr("Report the targets taking most of the build time"),
+                                   BoolAspect::LabelPlacement::AtCheckBox);
+    reportTargetDurations.setToolTip(
+        Tr::tr("The time of a target is measured from the previous target that finished. "
+               "With parallel jobs this is only accurate for targets that were not built "
+               "alongside others."));
+    reportTargetDurations.setDefaultValue(false);
+
     Kit *kit = buildConfiguration()->kit();
     if (XMakeBuildConfiguration::isIos(kit) && XMakeGeneratorKitAspect::generator(kit) == "Xcode") {
         useiOSAutomaticProvisioningUpdates.setDefaultValue(true);
@@ -247,8 +460,6 @@ XMakeBuildStep::XMakeBuildStep(BuildStepList *bsl, Id id) :
         useiOSAutomaticProvisioningUpdates.setVisible(false);
     }
 
-    m_buildTargetModel.setHeader({Tr::tr("Target")});
-
     setBuildTargets({defaultBuildTarget()});
     auto *bs = qobject_cast<XMakeBuildSystem *>(buildSystem());
     if (bs && !bs->buildTargets().isEmpty())
@@ -272,12 +483,33 @@ XMakeBuildStep::XMakeBuildStep(BuildStepList *bsl, Id id) :
     });
 
     connect(target(), &Target::parsingFinished, this, [this](bool success) {
-        if (success) // Do not change when parsing failed.
+        if (success) { // Do not change when parsing failed.
             recreateBuildTargetsModel();
+            pruneTargetDurations();
+        }
     });
 
     connect(target(), &Target::activeRunConfigurationChanged,
             this, &XMakeBuildStep::updateBuildTargetsModel);
+
+    connect(DocumentManager::instance(), &DocumentManager::filesChangedInternally,
+            this, &XMakeBuildStep::addChangedFiles);
+    // Other tools changing files are only noticed for open documents, so any sign of
+    // them means the changes since the last build are not known completely.
+    connect(DocumentManager::instance(), &DocumentManager::filesChangedExternally,
+            this, [this] {
+        m_changesTracked = false;
+        m_untrackedChangesDuringBuild = true;
+    });
+    connect(VcsManager::instance(), &VcsManager::repositoryChanged,
+            this, [this](const FilePath &repository) {
+        const FilePath projectDirectory = project()->projectDirectory();
+        if (projectDirectory == repository || projectDirectory.isChildOf(repository)
+            || repository.isChildOf(projectDirectory)) {
+            m_changesTracked = false;
+            m_untrackedChangesDuringBuild = true;
+        }
+    });
 }
 
 void XMakeBuildStep::toMap(Utils::Store &map) const
@@ -287,6 +519,11 @@ void XMakeBuildStep::toMap(Utils::Store &map) const
     map.insert(CLEAR_SYSTEM_ENVIRONMENT_KEY, m_clearSystemEnvironment);
     map.insert(USER_ENVIRONMENT_CHANGES_KEY, EnvironmentItem::toStringList(m_userEnvironmentChanges));
     map.insert(BUILD_PRESET_KEY, m_buildPreset);
+
+    QVariantMap durations;
+    for (auto it = m_targetDurations.cbegin(); it != m_targetDurations.cend(); ++it)
+        durations.insert(it.key(), it.value());
+    map.insert(TARGET_DURATIONS_KEY, durations);
 }
 
 void XMakeBuildStep::fromMap(const Utils::Store &map)
@@ -301,6 +538,11 @@ void XMakeBuildStep::fromMap(const Utils::Store &map)
 
     m_buildPreset = map.value(BUILD_PRESET_KEY).toString();
 
+    m_targetDurations.clear();
+    const QVariantMap durations = map.value(TARGET_DURATIONS_KEY).toMap();
+    for (auto it = durations.cbegin(); it != durations.cend(); ++it)
+        m_targetDurations.insert(it.key(), it.value().toLongLong());
+
     BuildStep::fromMap(map);
 }
 
@@ -323,6 +565,15 @@ bool XMakeBuildStep::init()
     }
 
     setIgnoreReturnValue(m_buildTargets == QStringList(XMakeBuildStep::cleanTarget()));
+    m_buildsAllTargets = m_buildTargets == QStringList(allTarget());
+    // Files saved while building may not be part of the build
+    m_buildChangedFiles = m_changedFiles;
+    m_untrackedChangesDuringBuild = false;
+    m_buildStartTime = QDateTime::currentDateTime();
+    m_buildInstalls = useStaging() || m_buildTargets.contains(installTarget());
+    const FilePath manifest = installManifestFile();
+    m_manifestModifiedBeforeBuild = manifest.lastModified();
+    m_manifestSizeBeforeBuild = manifest.fileSize();
 
     return true;
 }
@@ -331,8 +582,21 @@ void XMakeBuildStep::setupOutputFormatter(Utils::OutputFormatter *formatter)
 {
     XMakeParser *xmakeParser = new XMakeParser;
     CmakeProgressParser * const progressParser = new CmakeProgressParser;
-    connect(progressParser, &CmakeProgressParser::progress, this, [this](int percent) {
-        emit progress(percent, {});
+    progressParser->setExpectedDurations(expectedTargetDurations());
+    m_finishedTargets.clear();
+    connect(progressParser, &CmakeProgressParser::progress, this,
+            [this](int percent, const QString &message) {
+        emit progress(percent, message);
+    });
+    connect(progressParser, &CmakeProgressParser::targetFinished, this,
+            [this](const QString &target, qint64 msecs) {
+        // Near-zero samples come from targets that finished along with another one
+        if (msecs >= MIN_TARGET_DURATION_MSECS) {
+            const auto it = m_targetDurations.constFind(target);
+            m_targetDurations.insert(target, it == m_targetDurations.cend() ? msecs
+                                                                            : (*it + msecs) / 2);
+        }
+        m_finishedTargets.append({target, msecs});
     });
     formatter->addLineParser(progressParser);
     xmakeParser->setSourceDirectory(project()->projectDirectory());
@@ -377,11 +641,63 @@ GroupItem XMakeBuildStep::runRecipe()
         ignoreReturnValue() ? finishAllAndSuccess : stopOnError,
         ProjectParserTask(onParserSetup, onParserError, CallDoneIf::Error),
         defaultProcessTask(),
-        onGroupDone([this] { updateDeploymentData(); })
+        onGroupDone([this](DoneWith result) {
+            // A build of other targets leaves the changes for the next build of all targets
+            if (result == DoneWith::Success && m_buildsAllTargets) {
+                m_changedFiles.subtract(m_buildChangedFiles);
+                m_changesTracked = !m_untrackedChangesDuringBuild;
+            }
+            m_buildChangedFiles.clear();
+            if (reportTargetDurations())
+                reportSlowestTargets();
+            updateDeploymentData();
+        })
     };
     return root;
 }
 
+void XMakeBuildStep::reportSlowestTargets()
+{
+    if (m_finishedTargets.size() < 2)
+        return;
+
+    QList<QPair<QString, qint64>> targets = m_finishedTargets;
+    std::stable_sort(targets.begin(), targets.end(), [](const auto &a, const auto &b) {
+        return a.second > b.second;
+    });
+    targets = targets.mid(0, 3);
+
+    const QStringList entries = Utils::transform(targets, [](const QPair<QString, qint64> &t) {
+        return QString("%1 (%2)").arg(t.first, formatDuration(t.second));
+    });
+    emit addOutput(Tr::tr("Targets taking most of the build time: %1")
+                       .arg(entries.join(", ")),
+                   OutputFormat::NormalMessage);
+}
+
+// The progress lines name a target by its title or by its output file. The durations
+// of targets the project no longer has are dropped, as well as near-zero ones stored
+// for up-to-date targets.
+void XMakeBuildStep::pruneTargetDurations()
+{
+    auto bs = qobject_cast<XMakeBuildSystem *>(buildSystem());
+    if (!bs)
+        return;
+
+    QSet<QString> names;
+    for (const XMakeBuildTarget &target : bs->buildTargets()) {
+        names.insert(target.title);
+        if (!target.executable.isEmpty())
+            names.insert(target.executable.fileName());
+    }
+    for (auto it = m_targetDurations.begin(); it != m_targetDurations.end();) {
+        if (names.contains(it.key()) && it.value() >= MIN_TARGET_DURATION_MSECS)
+            ++it;
+        else
+            it = m_targetDurations.erase(it);
+    }
+}
+
 QString XMakeBuildStep::defaultBuildTarget() const
 {
     const BuildStepList *const bsl = stepList();
@@ -407,6 +723,66 @@ QStringList XMakeBuildStep::buildTargets() const
     return m_buildTargets;
 }
 
+// The targets passed to the build, with the affected targets and the current
+// executable resolved
+QStringList XMakeBuildStep::effectiveBuildTargets() const
+{
+    QStringList buildTargets = m_buildTargets;
+    if (buildAffectedTargetsOnly() && m_buildTargets == QStringList(allTarget())) {
+        const QStringList affected = affectedBuildTargets();
+        if (!affected.isEmpty())
+            buildTargets = affected;
+    }
+
+    return Utils::transform(buildTargets, [this](const QString &s) {
+        if (s.isEmpty()) {
+            if (RunConfiguration *rc = target()->activeRunConfiguration())
+                return rc->buildKey();
+        }
+        return s;
+    });
+}
+
+// The stored durations of the targets the build runs: the given targets and the ones
+// they depend on, or every target for special targets like all or install.
+QHash<QString, qint64> XMakeBuildStep::expectedTargetDurations() const
+{
+    auto bs = qobject_cast<XMakeBuildSystem *>(buildSystem());
+    if (!bs)
+        return {};
+
+    QHash<QString, const XMakeBuildTarget *> targetsByTitle;
+    for (const XMakeBuildTarget &target : bs->buildTargets())
+        targetsByTitle.insert(target.title, &target);
+
+    const QStringList special = specialTargets(bs->usesAllCapsTargets());
+    QList<const XMakeBuildTarget *> pending;
+    for (const QString &title : effectiveBuildTargets()) {
+        const XMakeBuildTarget *target = targetsByTitle.value(title);
+        if (!target || special.contains(title))
+            return m_targetDurations;
+        pending.append(target);
+    }
+
+    QHash<QString, qint64> durations;
+    QSet<QString> visited;
+    while (!pending.isEmpty()) {
+        const XMakeBuildTarget *target = pending.takeLast();
+        if (!Utils::insert(visited, target->title))
+            continue;
+        for (const QString &name : {target->title, target->executable.fileName()}) {
+            const auto it = m_targetDurations.constFind(name);
+            if (it != m_targetDurations.cend())
+                durations.insert(name, *it);
+        }
+        for (const QString &dependency : target->dependencies) {
+            if (const XMakeBuildTarget *dependencyTarget = targetsByTitle.value(dependency))
+                pending.append(dependencyTarget);
+        }
+    }
+    return durations;
+}
+
 bool XMakeBuildStep::buildsBuildTarget(const QString &target) const
 {
     return m_buildTargets.contains(target);
@@ -442,13 +818,7 @@ CommandLine XMakeBuildStep::xmakeCommand() const
     cmd.addArgs({"--build", XMakeToolManager::mappedFilePath(buildDirectory).path()});
 
     cmd.addArg("--target");
-    cmd.addArgs(Utils::transform(m_buildTargets, [this](const QString &s) {
-        if (s.isEmpty()) {
-            if (RunConfiguration *rc = target()->activeRunConfiguration())
-                return rc->buildKey();
-        }
-        return s;
-    }));
+    cmd.addArgs(effectiveBuildTargets());
     if (useStaging())
         cmd.addArg("install");
 
@@ -480,6 +850,32 @@ CommandLine XMakeBuildStep::xmakeCommand() const
     return cmd;
 }
 
+void XMakeBuildStep::addChangedFiles(const FilePaths &files)
+{
+    // New files are not known to the project yet, they still make the build fall back to all
+    const FilePath projectDirectory = project()->projectDirectory();
+    for (const FilePath &file : files) {
+        if (project()->isKnownFile(file) || file.isChildOf(projectDirectory)) {
+            m_changedFiles.insert(file);
+            // Saved again during the running build, keep it for the next one
+            m_buildChangedFiles.remove(file);
+        }
+    }
+}
+
+// Falls back to an empty list, meaning all targets, when nothing changed, when changes
+// made outside of the editor cannot be ruled out, or when a changed file is not a source
+// of a target.
+QStringList XMakeBuildStep::affectedBuildTargets() const
+{
+    if (!m_changesTracked || m_changedFiles.isEmpty())
+        return {};
+    auto bs = qobject_cast<XMakeBuildSystem *>(buildSystem());
+    if (!bs)
+        return {};
+    return bs->affectedBuildTargets(m_changedFiles).value_or(QStringList());
+}
+
 QString XMakeBuildStep::cleanTarget() const
 {
     return QString("clean");
@@ -552,10 +948,20 @@ QWidget *XMakeBuildStep::createConfigWidget()
     setDisplayName(Tr::tr("Build", "ConfigWidget display name."));
 
     auto buildTargetsView = new QTreeView;
+    auto filterModel = new QSortFilterProxyModel(buildTargetsView);
+    filterModel->setSourceModel(&m_buildTargetModel);
+    filterModel->setFilterCaseSensitivity(Qt::CaseInsensitive);
     buildTargetsView->setMinimumHeight(200);
-    buildTargetsView->setModel(&m_buildTargetModel);
+    buildTargetsView->setModel(filterModel);
     buildTargetsView->setRootIsDecorated(false);
     buildTargetsView->setHeaderHidden(true);
+    buildTargetsView->setUniformRowHeights(true);
+
+    auto filterEdit = new FancyLineEdit;
+    filterEdit->setFiltering(true);
+    filterEdit->setPlaceholderText(Tr::tr("Filter targets"));
+    connect(filterEdit, &FancyLineEdit::filterChanged,
+            filterModel, &QSortFilterProxyModel::setFilterFixedString);
 
     auto frame = ItemViewFind::createSearchableWrapper(buildTargetsView,
                                                        ItemViewFind::LightColored);
@@ -593,9 +999,14 @@ QWidget *XMakeBuildStep::createConfigWidget()
     builder.addRow({toolArguments});
     builder.addRow({useStaging});
     builder.addRow({stagingDir});
+    if (!isCleanStep()) {
+        builder.addRow({buildAffectedTargetsOnly});
+        builder.addRow({reportTargetDurations});
+    }
     builder.addRow({useiOSAutomaticProvisioningUpdates});
 
-    builder.addRow({new QLabel(Tr::tr("Targets:")), frame});
+    builder.addRow({new QLabel(Tr::tr("Targets:")), filterEdit});
+    builder.addRow({QString(), frame});
 
     if (!isCleanStep() && !m_buildPreset.isEmpty())
         createAndAddEnvironmentWidgets(builder);
@@ -609,6 +1020,7 @@ QWidget *XMakeBuildStep::createConfigWidget()
     connect(&toolArguments, &BaseAspect::changed, this, updateDetails);
     connect(&useStaging, &BaseAspect::changed, this, updateDetails);
     connect(&stagingDir, &BaseAspect::changed, this, updateDetails);
+    connect(&buildAffectedTargetsOnly, &BaseAspect::changed, this, updateDetails);
     connect(&useiOSAutomaticProvisioningUpdates, &BaseAspect::changed, this, updateDetails);
 
     connect(ProjectExplorerPlugin::instance(), &ProjectExplorerPlugin::settingsChanged,
@@ -624,13 +1036,6 @@ QWidget *XMakeBuildStep::createConfigWidget()
 
 void XMakeBuildStep::recreateBuildTargetsModel()
 {
-    auto addItem = [this](const QString &target, bool special = false) {
-        auto item = new XMakeTargetItem(target, this, special);
-        m_buildTargetModel.rootItem()->appendChild(item);
-    };
-
-    m_buildTargetModel.clear();
-
     auto bs = qobject_cast<XMakeBuildSystem *>(buildSystem());
     QStringList targetList = bs ? bs->buildTargetTitles() : QStringList();
 
@@ -648,27 +1053,31 @@ void XMakeBuildStep::recreateBuildTargetsModel()
     }
     targetList.removeDuplicates();
 
-    addItem(QString(), true);
-
     // Remove the targets that do not exist in the build system
     // This can result when selected targets get renamed
     if (!targetList.empty()) {
-        Utils::erase(m_buildTargets, [targetList](const QString &bt) {
-            return !bt.isEmpty() /* "current executable" */ && !targetList.contains(bt);
+        const QSet<QString> knownTargets(targetList.cbegin(), targetList.cend());
+        Utils::erase(m_buildTargets, [&knownTargets](const QString &bt) {
+            return !bt.isEmpty() /* "current executable" */ && !knownTargets.contains(bt);
         });
         if (m_buildTargets.empty())
             m_buildTargets.push_back(m_allTarget);
     }
 
-    for (const QString &buildTarget : std::as_const(targetList))
-        addItem(buildTarget, specialTargets(usesAllCapsTargets).contains(buildTarget));
+    QSet<QString> special{QString()};
+    for (const QString &target : specialTargets(usesAllCapsTargets)) {
+        if (targetList.contains(target))
+            special.insert(target);
+    }
+    targetList.prepend(QString()); // "current executable"
+    m_buildTargetModel.setTargets(targetList, special);
 
     updateBuildTargetsModel();
 }
 
 void XMakeBuildStep::updateBuildTargetsModel()
 {
-    emit m_buildTargetModel.layoutChanged();
+    m_buildTargetModel.updateCheckStates();
     emit buildTargetsChanged();
 }
 
@@ -753,8 +1162,7 @@ QString XMakeBuildStep::currentInstallPrefix() const
 {
     auto bs = qobject_cast<XMakeBuildSystem *>(buildSystem());
     QTC_ASSERT(bs, return {});
-    const XMakeConfig config = bs->configurationFromXMake();
-    return QString::fromUtf8(config.valueOf("XMAKE_INSTALL_PREFIX"));
+    return bs->configurationFromXMake().stringValueOf("XMAKE_INSTALL_PREFIX");
 }
 
 FilePath XMakeBuildStep::xmakeExecutable() const
@@ -796,12 +1204,85 @@ void XMakeBuildStep::updateDeploymentData()
             return IterationPolicy::Continue;
         };
 
-    rootDir.iterateDirectory(handleFile,
-                             {{}, QDir::Files | QDir::Hidden, QDirIterator::Subdirectories});
+    // Only crawl the staging directory when there is no usable install manifest
+    if (const std::optional<FilePaths> files = installedFiles(rootDir)) {
+        InstallManifest &manifest = m_installManifest;
+        if (manifest.deploymentData && manifest.deviceRoot == runDevice->rootPath()
+            && manifest.appFileNames == appFileNames) {
+            buildSystem()->setDeploymentData(*manifest.deploymentData);
+            return;
+        }
+        for (const FilePath &file : *files)
+            handleFile(file);
+        manifest.deploymentData = deploymentData;
+        manifest.deviceRoot = runDevice->rootPath();
+        manifest.appFileNames = appFileNames;
+    } else {
+        rootDir.iterateDirectory(handleFile,
+                                 {{}, QDir::Files | QDir::Hidden, QDirIterator::Subdirectories});
+    }
 
     buildSystem()->setDeploymentData(deploymentData);
 }
 
+FilePath XMakeBuildStep::installManifestFile() const
+{
+    if (!buildConfiguration())
+        return {};
+    return buildConfiguration()->buildDirectory() / "install_manifest.txt";
+}
+
+// The install step lists everything it installed, including up-to-date files, in
+// install_manifest.txt. The list is only trusted when the last build of this step
+// installed and wrote it, the files in it were installed by that build then. It is
+// re-read when the manifest changed, and parsed again only when its contents changed.
+std::optional<FilePaths> XMakeBuildStep::installedFiles(const FilePath &rootDir)
+{
+    const FilePath manifest = installManifestFile();
+    const QDateTime lastModified = manifest.lastModified();
+    if (!lastModified.isValid() || !m_buildInstalls)
+        return {};
+
+    // Written during the build if it changed, or if its time is not before the start of the
+    // build. FAT only stores times in steps of two seconds, so the start is rounded down.
+    const bool changed = lastModified != m_manifestModifiedBeforeBuild
+                         || manifest.fileSize() != m_manifestSizeBeforeBuild;
+    const qint64 startSecs = m_buildStartTime.toSecsSinceEpoch() / 2 * 2;
+    if (!changed && lastModified.toSecsSinceEpoch() < startSecs)
+        return {};
+
+    if (manifest != m_installManifest.filePath || lastModified != m_installManifest.lastModified
+        || rootDir != m_installManifest.rootDir) {
+        const expected_str<QByteArray> contents = manifest.fileContents();
+        if (!contents)
+            return {};
+        if (manifest == m_installManifest.filePath && rootDir == m_installManifest.rootDir
+            && *contents == m_installManifest.contents) {
+            m_installManifest.lastModified = lastModified;
+        } else {
+            FilePaths files;
+            bool inStagingDir = true;
+            for (const QByteArray &line : contents->split('\n')) {
+                const QString path = QString::fromUtf8(line).trimmed();
+                if (path.isEmpty())
+                    continue;
+                const FilePath file = rootDir.withNewPath(path);
+                // Left over from an install without staging
+                if (!file.isChildOf(rootDir)) {
+                    inStagingDir = false;
+                    break;
+                }
+                files.append(file);
+            }
+            m_installManifest = {manifest, lastModified, rootDir, *contents, inStagingDir, files};
+        }
+    }
+
+    if (!m_installManifest.isUsable)
+        return {};
+    return m_installManifest.files;
+}
+
 // XMakeBuildStepFactory
 
 class XMakeBuildStepFactory final : public BuildStepFactory
@@ -6,7 +6,12 @@
 #include <qglobal.h>
 
 #include "xmakeabstractprocessstep.h"
-#include <utils/treemodel.h>
+
+#include <projectexplorer/deploymentdata.h>
+
+#include <QAbstractListModel>
+#include <QDateTime>
+#include <QSet>
 
 namespace Utils {
     class CommandLine;
@@ -16,19 +21,25 @@ namespace Utils {
 namespace XMakeProjectManager::Internal {
     class XMakeBuildStep;
 
-    class XMakeTargetItem : public Utils::TreeItem {
+    // Flat list of the build targets. Rows are plain strings that are only turned into
+    // display data when a view asks for them, and setTargets() only inserts and removes
+    // the rows that changed.
+    class XMakeTargetModel final : public QAbstractListModel {
 public:
-        XMakeTargetItem() = default;
-        XMakeTargetItem(const QString &target, XMakeBuildStep *step, bool special);
+        explicit XMakeTargetModel(XMakeBuildStep *step);
 
-private:
-        QVariant data(int column, int role) const final;
-        bool setData(int column, const QVariant &data, int role) final;
-        Qt::ItemFlags flags(int column) const final;
+        void setTargets(const QStringList &targets, const QSet<QString> &specialTargets);
+        void updateCheckStates();
 
-        QString m_target;
+        int rowCount(const QModelIndex &parent = {}) const final;
+        QVariant data(const QModelIndex &index, int role) const final;
+        bool setData(const QModelIndex &index, const QVariant &value, int role) final;
+        Qt::ItemFlags flags(const QModelIndex &index) const final;
+
+private:
         XMakeBuildStep *m_step = nullptr;
-        bool m_special = false;
+        QStringList m_targets;
+        QSet<QString> m_specialTargets;
     };
 
     class XMakeBuildStep : public XMakeAbstractProcessStep {
@@ -73,6 +84,8 @@ public:
         Utils::BoolAspect useiOSAutomaticProvisioningUpdates { this };
         Utils::BoolAspect useStaging { this };
         Utils::FilePathAspect stagingDir { this };
+        Utils::BoolAspect buildAffectedTargetsOnly { this };
+        Utils::BoolAspect reportTargetDurations { this };
 
 signals:
         void buildTargetsChanged();
@@ -98,6 +111,14 @@ private:
         void recreateBuildTargetsModel();
         void updateBuildTargetsModel();
         void updateDeploymentData();
+        Utils::FilePath installManifestFile() const;
+        std::optional<Utils::FilePaths> installedFiles(const Utils::FilePath &rootDir);
+        void reportSlowestTargets();
+        void pruneTargetDurations();
+        void addChangedFiles(const Utils::FilePaths &files);
+        QStringList affectedBuildTargets() const;
+        QStringList effectiveBuildTargets() const;
+        QHash<QString, qint64> expectedTargetDurations() const;
 
         friend class XMakeBuildStepConfigWidget;
         QStringList m_buildTargets; // Convention: Empty string member signifies "Current executable"
@@ -105,13 +126,46 @@ private:
         QString m_allTarget = "all";
         QString m_installTarget = "install";
 
-        Utils::TreeModel<Utils::TreeItem, XMakeTargetItem> m_buildTargetModel;
+        XMakeTargetModel m_buildTargetModel{this};
 
         Utils::Environment m_environment;
         Utils::EnvironmentItems m_userEnvironmentChanges;
         bool m_clearSystemEnvironment = false;
         QString m_buildPreset;
         std::optional<QString> m_configuration;
+
+        // Build time per target, from the latest build that finished the target
+        QHash<QString, qint64> m_targetDurations;
+        QList<QPair<QString, qint64>> m_finishedTargets;
+
+        struct InstallManifest {
+            Utils::FilePath filePath;
+            QDateTime lastModified;
+            Utils::FilePath rootDir;
+            QByteArray contents;
+            bool isUsable = false;
+            Utils::FilePaths files;
+            // Built from the files, reused while the device and the applications are the same
+            std::optional<ProjectExplorer::DeploymentData> deploymentData;
+            Utils::FilePath deviceRoot;
+            QSet<QString> appFileNames;
+        };
+        InstallManifest m_installManifest;
+        // The last build of this step: its start, the manifest before it and whether it
+        // ran the install target
+        QDateTime m_buildStartTime;
+        QDateTime m_manifestModifiedBeforeBuild;
+        qint64 m_manifestSizeBeforeBuild = -1;
+        bool m_buildInstalls = false;
+
+        // Project files changed since the last successful build of all targets
+        QSet<Utils::FilePath> m_changedFiles;
+        // No change outside of Qt Creator was noticed since that build
+        bool m_changesTracked = false;
+        bool m_buildsAllTargets = false;
+        // The changed files when the running build started
+        QSet<Utils::FilePath> m_buildChangedFiles;
+        bool m_untrackedChangesDuringBuild = false;
     };
 
     void setupXMakeBuildStep();
@@ -32,6 +32,7 @@
 #include <projectexplorer/projectupdater.h>
 #include <projectexplorer/target.h>
 #include <projectexplorer/taskhub.h>
+#include <projectexplorer/toolchain.h>
 
 #include <texteditor/texteditor.h>
 #include <texteditor/textdocument.h>
@@ -44,7 +45,9 @@
 #include <qtsupport/qtsupportconstants.h>
 
 #include <utils/algorithm.h>
+#include <utils/async.h>
 #include <utils/checkablemessagebox.h>
+#include <utils/filesystemwatcher.h>
 #include <utils/macroexpander.h>
 #include <utils/mimeconstants.h>
 #include <utils/process.h>
@@ -56,6 +59,8 @@
 #include <QJsonDocument>
 #include <QJsonObject>
 #include <QLoggingCategory>
+#include <QPromise>
+#include <QTextCursor>
 
 using namespace ProjectExplorer;
 using namespace TextEditor;
@@ -131,6 +136,9 @@ namespace XMakeProjectManager::Internal {
             future.waitForFinished();
         }
 
+        m_qmlCodeModelFuture.cancel();
+        m_scanDirectoriesFuture.cancel();
+
         delete m_cppCodeModelUpdater;
         qDeleteAll(m_extraCompilers);
     }
@@ -187,9 +195,10 @@ namespace XMakeProjectManager::Internal {
             reparseParameters |= REPARSE_FORCE_XMAKE_RUN | REPARSE_FORCE_EXTRA_CONFIGURATION;
         }
 
-        // The code model will be updated after the XMake run. There is no need to have an
-        // active code model updater when the next one will be triggered.
-        m_cppCodeModelUpdater->cancel();
+        // A running C++ code model update is not cancelled here: the project part hashes
+        // assume that the last update reached the code model, and a newer update supersedes
+        // a running one anyway.
+        m_qmlCodeModelFuture.cancel();
 
         const XMakeTool *tool = m_parameters.xmakeTool();
         XMakeTool::Version version = tool ? tool->version() : XMakeTool::Version();
@@ -387,25 +396,8 @@ namespace XMakeProjectManager::Internal {
         }
         return result;
     }
-    static expected_str<bool> insertSnippetSilently(const FilePath &xmakeFile,
-                                                    const SnippetAndLocation &snippetLocation) {
-        BaseTextEditor *editor = qobject_cast<BaseTextEditor *>(
-            Core::EditorManager::openEditorAt({ xmakeFile,
-                                                int(snippetLocation.line),
-                                                int(snippetLocation.column) },
-                                              Constants::XMAKE_EDITOR_ID,
-                                              Core::EditorManager::DoNotMakeVisible));
-        if (!editor) {
-            return make_unexpected("BaseTextEditor cannot be obtained for " + xmakeFile.toUserOutput()
-                                   + ":" + QString::number(snippetLocation.line) + ":"
-                                   + QString::number(snippetLocation.column));
-        }
-        editor->insert(snippetLocation.snippet);
-        editor->editorWidget()->autoIndent();
-        if (!Core::DocumentManager::saveDocument(editor->document())) {
-            return make_unexpected("Changes to " + xmakeFile.toUserOutput() + " could not be saved.");
-        }
-        return true;
+    static XMakeBuildSystem::ProjectFileEdit editForSnippet(const SnippetAndLocation &snippetLocation) {
+        return { snippetLocation.line, snippetLocation.column, 0, snippetLocation.snippet };
     }
 
     static void findLastRelevantArgument(const cmListFileFunction &function,
@@ -508,19 +500,18 @@ namespace XMakeProjectManager::Internal {
                                   std::nullopt, { "options" }, lastArgumentPos);
     }
 
-    static expected_str<bool> insertQtAddTranslations(const cmListFile &xmakeListFile,
-                                                      const FilePath &targetCmakeFile,
-                                                      const QString &targetName,
-                                                      int targetDefinitionLine,
-                                                      const QString &filesToAdd,
-                                                      int qtMajorVersion,
-                                                      bool addLinguist) {
+    static QList<SnippetAndLocation> qtAddTranslationsSnippets(const cmListFile &xmakeListFile,
+                                                               const QString &targetName,
+                                                               int targetDefinitionLine,
+                                                               const QString &filesToAdd,
+                                                               int qtMajorVersion,
+                                                               bool addLinguist) {
         std::optional<cmListFileFunction> function
             = findFunction(xmakeListFile, [targetDefinitionLine](const auto &func) {
                                return func.Line() == targetDefinitionLine;
                            });
         if (!function.has_value()) {
-            return false;
+            return {};
         }
 
         // FIXME: room for improvement
@@ -534,10 +525,9 @@ namespace XMakeProjectManager::Internal {
         }
 
         const int insertionLine = function->LineEnd() + 1;
-        expected_str<bool> inserted = insertSnippetSilently(targetCmakeFile,
-                                                            { snippet, insertionLine, 0 });
-        if (!inserted || !addLinguist) {
-            return inserted;
+        QList<SnippetAndLocation> snippets { { snippet, insertionLine, 0 } };
+        if (!addLinguist) {
+            return snippets;
         }
 
         function = findFunction(xmakeListFile, [](const auto &func) {
@@ -545,16 +535,17 @@ namespace XMakeProjectManager::Internal {
                                 }, /* reverse = */ true);
         if (!function.has_value()) {
             qCCritical(xmakeBuildSystemLog) << "Failed to find a find_package().";
-            return inserted; // we just fail to insert LinguistTool, but otherwise succeeded
+            return snippets; // we just fail to insert LinguistTool, but otherwise succeeded
         }
         if (insertionLine < function->LineEnd() + 1) {
             qCCritical(xmakeBuildSystemLog) << "find_package() calls after old insertion. "
                 "Refusing to process.";
-            return inserted; // we just fail to insert LinguistTool, but otherwise succeeded
+            return snippets; // we just fail to insert LinguistTool, but otherwise succeeded
         }
 
         snippet = QString("find_package(Qt%1 REQUIRED COMPONENTS LinguistTools)\n").arg(qtMajorVersion);
-        return insertSnippetSilently(targetCmakeFile, { snippet, function->LineEnd() + 1, 0 });
+        snippets.append({ snippet, function->LineEnd() + 1, 0 });
+        return snippets;
     }
 
     bool XMakeBuildSystem::addTsFiles(Node *context, const FilePaths &filePaths, FilePaths *notAdded) {
@@ -570,7 +561,7 @@ namespace XMakeProjectManager::Internal {
             }
 
             const FilePath targetXMakeFile = xmakeFile->targetFilePath;
-            std::optional<cmListFile> xmakeListFile = getUncachedXMakeListFile(targetXMakeFile);
+            std::optional<cmListFile> xmakeListFile = xmakeListFileForEditing(targetXMakeFile);
             if (!xmakeListFile.has_value()) {
                 return false;
             }
@@ -602,22 +593,25 @@ namespace XMakeProjectManager::Internal {
                 }
 
                 // we failed to find any pre-existing, add one ourself
-                expected_str<bool> inserted = insertQtAddTranslations(*xmakeListFile,
-                                                                      targetXMakeFile,
-                                                                      targetName,
-                                                                      xmakeFile->targetLine,
-                                                                      filesToAdd,
-                                                                      qtMajorVersion,
-                                                                      linguistToolsMissing);
-                if (!inserted) {
-                    qCCritical(xmakeBuildSystemLog) << inserted.error();
-                } else if (notAdded) {
+                const QList<SnippetAndLocation> snippets = qtAddTranslationsSnippets(*xmakeListFile,
+                                                                                     targetName,
+                                                                                     xmakeFile->targetLine,
+                                                                                     filesToAdd,
+                                                                                     qtMajorVersion,
+                                                                                     linguistToolsMissing);
+                if (snippets.isEmpty()) {
+                    return false;
+                }
+
+                for (const SnippetAndLocation &snippetLocation : snippets) {
+                    queueProjectFileEdit(targetXMakeFile, editForSnippet(snippetLocation));
+                }
+                if (notAdded) {
                     notAdded->removeIf([filePaths](const FilePath &p) {
                                            return filePaths.contains(p);
                                        });
                 }
-
-                return inserted.value_or(false);
+                return true;
             }
 
             auto lastArgument = function->Arguments().at(lastArgumentPos);
@@ -629,11 +623,7 @@ namespace XMakeProjectManager::Internal {
                 snippetLocation.column += 2;
             }
 
-            expected_str<bool> inserted = insertSnippetSilently(targetXMakeFile, snippetLocation);
-            if (!inserted) {
-                qCCritical(xmakeBuildSystemLog) << inserted.error();
-                return false;
-            }
+            queueProjectFileEdit(targetXMakeFile, editForSnippet(snippetLocation));
 
             if (notAdded) {
                 notAdded->removeIf([filePaths](const FilePath &p) {
@@ -652,49 +642,21 @@ namespace XMakeProjectManager::Internal {
 
         if (auto n = dynamic_cast<XMakeTargetNode *>(context)) {
             const QString targetName = n->buildKey();
-            const std::optional<Link> xmakeFile = xmakeFileForBuildKey(targetName, buildTargets());
-            if (!xmakeFile) {
-                return false;
-            }
-
-            const FilePath targetXMakeFile = xmakeFile->targetFilePath;
-            const int targetDefinitionLine = xmakeFile->targetLine;
-
-            std::optional<cmListFile> xmakeListFile = getUncachedXMakeListFile(targetXMakeFile);
-            if (!xmakeListFile) {
-                return false;
-            }
-
-            std::optional<cmListFileFunction> function
-                = findFunction(*xmakeListFile, [targetDefinitionLine](const auto &func) {
-                                   return func.Line() == targetDefinitionLine;
-                               });
-            if (!function.has_value()) {
-                qCCritical(xmakeBuildSystemLog) << "Function that defined the target" << targetName
-                                                << "could not be found at" << targetDefinitionLine;
+            if (!xmakeFileForBuildKey(targetName, buildTargets())) {
                 return false;
             }
 
-            const std::string target_name = function->Arguments().front().Value;
-            auto qtAddModule = [target_name](const auto &func) {
-                return (func.LowerCaseName() == "qt_add_qml_module"
-                    || func.LowerCaseName() == "qt6_add_qml_module")
-                       && func.Arguments().front().Value == target_name;
-            };
-            // Special case: when qt_add_executable and qt_add_qml_module use the same target name
-            // then qt_add_qml_module function should be used
-            function = findFunction(*xmakeListFile, qtAddModule).value_or(*function);
-
-            const QString newSourceFiles = newFilesForFunction(function->LowerCaseName(),
-                                                               filePaths,
-                                                               n->filePath().canonicalPath());
-
-            const SnippetAndLocation snippetLocation = generateSnippetAndLocationForSources(
-                newSourceFiles, *xmakeListFile, *function, targetName);
-            expected_str<bool> inserted = insertSnippetSilently(targetXMakeFile, snippetLocation);
-            if (!inserted) {
-                qCCritical(xmakeBuildSystemLog) << inserted.error();
-                return false;
+            // The script is edited when the transaction ends, so that all files added to the
+            // same target end up in one snippet.
+            const FilePath projDir = n->filePath().canonicalPath();
+            auto pending = std::find_if(m_pendingSourceFiles.begin(), m_pendingSourceFiles.end(),
+                                        [&targetName](const PendingSourceFiles &p) {
+                                            return p.targetName == targetName;
+                                        });
+            if (pending == m_pendingSourceFiles.end()) {
+                m_pendingSourceFiles.append({ targetName, projDir, filePaths });
+            } else {
+                pending->filePaths.append(filePaths);
             }
 
             if (notAdded) {
@@ -708,11 +670,58 @@ namespace XMakeProjectManager::Internal {
         return false;
     }
 
+    bool XMakeBuildSystem::addSrcFilesToTarget(const QString &targetName,
+                                               const FilePath &projDir,
+                                               const FilePaths &filePaths) {
+        const std::optional<Link> xmakeFile = xmakeFileForBuildKey(targetName, buildTargets());
+        if (!xmakeFile) {
+            return false;
+        }
+
+        const FilePath targetXMakeFile = xmakeFile->targetFilePath;
+        const int targetDefinitionLine = xmakeFile->targetLine;
+
+        std::optional<cmListFile> xmakeListFile = xmakeListFileForEditing(targetXMakeFile);
+        if (!xmakeListFile) {
+            return false;
+        }
+
+        std::optional<cmListFileFunction> function
+            = findFunction(*xmakeListFile, [targetDefinitionLine](const auto &func) {
+                               return func.Line() == targetDefinitionLine;
+                           });
+        if (!function.has_value()) {
+            qCCritical(xmakeBuildSystemLog) << "Function that defined the target" << targetName
+                                            << "could not be found at" << targetDefinitionLine;
+            return false;
+        }
+
+        const std::string target_name = function->Arguments().front().Value;
+        auto qtAddModule = [target_name](const auto &func) {
+            return (func.LowerCaseName() == "qt_add_qml_module"
+                || func.LowerCaseName() == "qt6_add_qml_module")
+                   && func.Arguments().front().Value == target_name;
+        };
+        // Special case: when qt_add_executable and qt_add_qml_module use the same target name
+        // then qt_add_qml_module function should be used
+        function = findFunction(*xmakeListFile, qtAddModule).value_or(*function);
+
+        const QString newSourceFiles = newFilesForFunction(function->LowerCaseName(),
+                                                           filePaths,
+                                                           projDir);
+
+        const SnippetAndLocation snippetLocation = generateSnippetAndLocationForSources(
+            newSourceFiles, *xmakeListFile, *function, targetName);
+        queueProjectFileEdit(targetXMakeFile, editForSnippet(snippetLocation));
+        return true;
+    }
+
     bool XMakeBuildSystem::addFiles(Node *context, const FilePaths &filePaths, FilePaths *notAdded) {
         FilePaths tsFiles, srcFiles;
         std::tie(tsFiles, srcFiles) = Utils::partition(filePaths, [](const FilePath &fp) {
                                                            return Utils::mimeTypeForFile(fp.toString()).name() == Utils::Constants::LINGUIST_MIMETYPE;
                                                        });
+        beginProjectFileEdits();
         bool success = true;
         if (!srcFiles.isEmpty()) {
             success = addSrcFiles(context, srcFiles, notAdded);
@@ -722,6 +731,17 @@ namespace XMakeProjectManager::Internal {
             success = addTsFiles(context, tsFiles, notAdded) || success;
         }
 
+        if (!endProjectFileEdits()) {
+            if (notAdded) {
+                for (const FilePath &filePath : filePaths) {
+                    if (!notAdded->contains(filePath)) {
+                        notAdded->append(filePath);
+                    }
+                }
+            }
+            success = false;
+        }
+
         if (success) {
             return true;
         }
@@ -730,17 +750,27 @@ namespace XMakeProjectManager::Internal {
 
     std::optional<XMakeBuildSystem::ProjectFileArgumentPosition>
     XMakeBuildSystem::projectFileArgumentPosition(const QString &targetName, const QString &fileName) {
+        const QList<ProjectFileArgumentPosition> positions = projectFileArgumentPositions(targetName,
+                                                                                          fileName);
+        if (positions.isEmpty()) {
+            return std::nullopt;
+        }
+        return positions.first();
+    }
+
+    QList<XMakeBuildSystem::ProjectFileArgumentPosition>
+    XMakeBuildSystem::projectFileArgumentPositions(const QString &targetName, const QString &fileName) {
         const std::optional<Link> xmakeFile = xmakeFileForBuildKey(targetName, buildTargets());
         if (!xmakeFile) {
-            return std::nullopt;
+            return {};
         }
 
         const FilePath targetXMakeFile = xmakeFile->targetFilePath;
         const int targetDefinitionLine = xmakeFile->targetLine;
 
-        std::optional<cmListFile> xmakeListFile = getUncachedXMakeListFile(targetXMakeFile);
+        std::optional<cmListFile> xmakeListFile = xmakeListFileForEditing(targetXMakeFile);
         if (!xmakeListFile) {
-            return std::nullopt;
+            return {};
         }
 
         std::optional<cmListFileFunction> function
@@ -750,7 +780,7 @@ namespace XMakeProjectManager::Internal {
         if (!function.has_value()) {
             qCCritical(xmakeBuildSystemLog) << "Function that defined the target" << targetName
                                             << "could not be found at" << targetDefinitionLine;
-            return std::nullopt;
+            return {};
         }
 
         const std::string target_name = targetName.toStdString();
@@ -769,17 +799,31 @@ namespace XMakeProjectManager::Internal {
                                                       return func.LowerCaseName() == "set_source_files_properties";
                                                   });
 
+        const std::string file_name = fileName.toStdString();
+        QList<ProjectFileArgumentPosition> result;
+        auto addPosition = [&result](const ProjectFileArgumentPosition &position) {
+            const bool known = Utils::contains(result, [&position](const ProjectFileArgumentPosition &p) {
+                                                   return p.fromGlobbing == position.fromGlobbing
+                                                          && p.argumentPosition.Line == position.argumentPosition.Line
+                                                          && p.argumentPosition.Column == position.argumentPosition.Column;
+                                               });
+            if (!known) {
+                result.append(position);
+            }
+        };
+
         for (const auto &func : { function, targetSourcesFunc, addQmlModuleFunc, setSourceFilePropFunc }) {
             if (!func.has_value()) {
                 continue;
             }
-            auto filePathArgument = Utils::findOrDefault(
-                func->Arguments(), [file_name = fileName.toStdString()](const auto &arg) {
-                    return arg.Value == file_name;
-                });
+            const auto filePathArguments = Utils::filtered(func->Arguments(), [&file_name](const auto &arg) {
+                                                               return arg.Value == file_name;
+                                                           });
 
-            if (!filePathArgument.Value.empty()) {
-                return ProjectFileArgumentPosition { filePathArgument, targetXMakeFile, fileName };
+            if (!filePathArguments.empty()) {
+                for (const auto &filePathArgument : filePathArguments) {
+                    addPosition({ filePathArgument, targetXMakeFile, fileName });
+                }
             } else {
                 // Check if the filename is part of globbing variable result
                 const auto globFunctions = std::get<0>(
@@ -799,10 +843,8 @@ namespace XMakeProjectManager::Internal {
                                                        });
 
                 if (haveGlobbing) {
-                    return ProjectFileArgumentPosition { filePathArgument,
-                                                         targetXMakeFile,
-                                                         fileName,
-                                                         true };
+                    addPosition({ cmListFileArgument(), targetXMakeFile, fileName, true });
+                    continue;
                 }
 
                 // Check if the filename is part of a variable set by the user
@@ -817,23 +859,17 @@ namespace XMakeProjectManager::Internal {
                                                             });
 
                     for (const auto &f : matchedFunctions) {
-                        filePathArgument = Utils::findOrDefault(f.Arguments(),
-                                                                [file_name = fileName.toStdString()](
-                                                                    const auto &arg) {
-                                                                    return arg.Value == file_name;
-                                                                });
-
-                        if (!filePathArgument.Value.empty()) {
-                            return ProjectFileArgumentPosition { filePathArgument,
-                                                                 targetXMakeFile,
-                                                                 fileName };
+                        for (const auto &setArgument : f.Arguments()) {
+                            if (setArgument.Value == file_name) {
+                                addPosition({ setArgument, targetXMakeFile, fileName });
+                            }
                         }
                     }
                 }
             }
         }
 
-        return std::nullopt;
+        return result;
     }
 
     RemovedFilesFromProject XMakeBuildSystem::removeFiles(Node *context,
@@ -844,6 +880,8 @@ namespace XMakeProjectManager::Internal {
             const FilePath projDir = n->filePath().canonicalPath();
             const QString targetName = n->buildKey();
 
+            FilePaths queuedFiles;
+            beginProjectFileEdits();
             for (const auto &file : filePaths) {
                 const QString fileName
                     = file.canonicalPath().relativePathFrom(projDir).cleanPath().toString();
@@ -858,23 +896,6 @@ namespace XMakeProjectManager::Internal {
                         continue;
                     }
 
-                    BaseTextEditor *editor = qobject_cast<BaseTextEditor *>(
-                        Core::EditorManager::openEditorAt({ filePos.value().xmakeFile,
-                                                            static_cast<int>(filePos.value().argumentPosition.Line),
-                                                            static_cast<int>(filePos.value().argumentPosition.Column
-                                                                - 1) },
-                                                          Constants::XMAKE_EDITOR_ID,
-                                                          Core::EditorManager::DoNotMakeVisible));
-                    if (!editor) {
-                        badFiles << file;
-
-                        qCCritical(xmakeBuildSystemLog).noquote()
-                            << "BaseTextEditor cannot be obtained for"
-                            << filePos.value().xmakeFile.path() << filePos.value().argumentPosition.Line
-                            << int(filePos.value().argumentPosition.Column - 1);
-                        continue;
-                    }
-
                     // If quotes were used for the source file, remove the quotes too
                     int extraChars = 0;
                     if (filePos->argumentPosition.Delim == cmListFileArgument::Quoted) {
@@ -882,22 +903,20 @@ namespace XMakeProjectManager::Internal {
                     }
 
                     if (!filePos.value().fromGlobbing) {
-                        editor->replace(filePos.value().relativeFileName.length() + extraChars, "");
-                    }
-
-                    editor->editorWidget()->autoIndent();
-                    if (!Core::DocumentManager::saveDocument(editor->document())) {
-                        badFiles << file;
-
-                        qCCritical(xmakeBuildSystemLog).noquote()
-                            << "Changes to" << filePos.value().xmakeFile.path()
-                            << "could not be saved.";
-                        continue;
+                        queueProjectFileEdit(filePos->xmakeFile,
+                                             { filePos->argumentPosition.Line,
+                                               filePos->argumentPosition.Column - 1,
+                                               int(filePos->relativeFileName.length()) + extraChars,
+                                               QString() });
                     }
+                    queuedFiles << file;
                 } else {
                     badFiles << file;
                 }
             }
+            if (!endProjectFileEdits()) {
+                badFiles << queuedFiles;
+            }
 
             if (notRemoved && !badFiles.isEmpty()) {
                 *notRemoved = badFiles;
@@ -966,55 +985,139 @@ namespace XMakeProjectManager::Internal {
                 return false;
             }
 
-            do {
-                BaseTextEditor *editor = qobject_cast<BaseTextEditor *>(
-                    Core::EditorManager::openEditorAt(
-                        { fileToRename->xmakeFile,
-                          static_cast<int>(fileToRename->argumentPosition.Line),
-                          static_cast<int>(fileToRename->argumentPosition.Column - 1) },
-                        Constants::XMAKE_EDITOR_ID,
-                        Core::EditorManager::DoNotMakeVisible));
-                if (!editor) {
-                    qCCritical(xmakeBuildSystemLog).noquote()
-                        << "BaseTextEditor cannot be obtained for" << fileToRename->xmakeFile.path()
-                        << fileToRename->argumentPosition.Line
-                        << int(fileToRename->argumentPosition.Column);
-                    return false;
+            // All occurrences are collected from one parse of the script, e.g. when
+            // set_source_files_properties is used, and written back together.
+            beginProjectFileEdits();
+            const QList<ProjectFileArgumentPosition> positions
+                = projectFileArgumentPositions(targetName, oldRelPathName);
+            for (const ProjectFileArgumentPosition &position : positions) {
+                if (position.fromGlobbing) {
+                    continue;
                 }
 
                 // If quotes were used for the source file, skip the starting quote
-                if (fileToRename->argumentPosition.Delim == cmListFileArgument::Quoted) {
-                    editor->setCursorPosition(editor->position() + 1);
-                }
-
-                if (!fileToRename->fromGlobbing) {
-                    editor->replace(fileToRename->relativeFileName.length(), newRelPathName);
-                }
+                const int quote = position.argumentPosition.Delim == cmListFileArgument::Quoted ? 1 : 0;
+                queueProjectFileEdit(position.xmakeFile,
+                                     { position.argumentPosition.Line,
+                                       position.argumentPosition.Column - 1 + quote,
+                                       int(position.relativeFileName.length()),
+                                       newRelPathName });
+            }
+            return endProjectFileEdits();
+        }
 
-                editor->editorWidget()->autoIndent();
-                if (!Core::DocumentManager::saveDocument(editor->document())) {
-                    qCCritical(xmakeBuildSystemLog).noquote()
-                        << "Changes to" << fileToRename->xmakeFile.path() << "could not be saved.";
-                    return false;
-                }
+        return false;
+    }
 
-                // Try the next occurrence. This can happen if set_source_file_properties is used
-                fileToRename = projectFileArgumentPosition(targetName, oldRelPathName);
-            } while (fileToRename);
+    void XMakeBuildSystem::beginProjectFileEdits() {
+        ++m_projectFileEditDepth;
+    }
 
+    bool XMakeBuildSystem::endProjectFileEdits() {
+        QTC_ASSERT(m_projectFileEditDepth > 0, return false);
+        if (--m_projectFileEditDepth > 0) {
             return true;
         }
 
-        return false;
+        bool success = true;
+
+        // The queued additions still need the cached parses to compute their positions
+        ++m_projectFileEditDepth;
+        const QList<PendingSourceFiles> pendingSourceFiles = std::exchange(m_pendingSourceFiles, {});
+        for (const PendingSourceFiles &pending : pendingSourceFiles) {
+            success = addSrcFilesToTarget(pending.targetName, pending.projectDirectory, pending.filePaths)
+                      && success;
+        }
+        --m_projectFileEditDepth;
+
+        m_editedXMakeListFiles.clear();
+        const QHash<FilePath, QList<ProjectFileEdit>> edits = std::exchange(m_projectFileEdits, {});
+        for (auto it = edits.cbegin(); it != edits.cend(); ++it) {
+            success = applyProjectFileEdits(it.key(), it.value()) && success;
+        }
+        return success;
+    }
+
+    std::optional<cmListFile> XMakeBuildSystem::xmakeListFileForEditing(const FilePath &xmakeFile) {
+        if (m_projectFileEditDepth == 0) {
+            return getUncachedXMakeListFile(xmakeFile);
+        }
+
+        // Within a transaction the script is not modified until the end, so one parse
+        // stays valid for all queued edits.
+        const auto it = m_editedXMakeListFiles.constFind(xmakeFile);
+        if (it != m_editedXMakeListFiles.cend()) {
+            return *it;
+        }
+        std::optional<cmListFile> xmakeListFile = getUncachedXMakeListFile(xmakeFile);
+        if (xmakeListFile) {
+            m_editedXMakeListFiles.insert(xmakeFile, *xmakeListFile);
+        }
+        return xmakeListFile;
+    }
+
+    void XMakeBuildSystem::queueProjectFileEdit(const FilePath &xmakeFile, const ProjectFileEdit &edit) {
+        QTC_ASSERT(m_projectFileEditDepth > 0, return );
+        m_projectFileEdits[xmakeFile].append(edit);
+    }
+
+    bool XMakeBuildSystem::applyProjectFileEdits(const FilePath &xmakeFile,
+                                                 QList<ProjectFileEdit> edits) {
+        BaseTextEditor *editor = qobject_cast<BaseTextEditor *>(
+            Core::EditorManager::openEditor(xmakeFile,
+                                            Constants::XMAKE_EDITOR_ID,
+                                            Core::EditorManager::DoNotMakeVisible));
+        if (!editor) {
+            qCCritical(xmakeBuildSystemLog).noquote()
+                << "BaseTextEditor cannot be obtained for" << xmakeFile.toUserOutput();
+            return false;
+        }
+
+        // All positions refer to the unmodified file. Apply them bottom-up so that earlier
+        // positions stay valid; edits at the same position keep their queued order.
+        std::stable_sort(edits.begin(), edits.end(), [](const ProjectFileEdit &a, const ProjectFileEdit &b) {
+                             return std::tie(a.line, a.column) < std::tie(b.line, b.column);
+                         });
+        // Re-indenting changes the columns, so it happens once all edits are in. The cursors
+        // follow the later edits, which are all at earlier positions.
+        TextEditorWidget *widget = editor->editorWidget();
+        QList<QTextCursor> editedRanges;
+        for (auto it = edits.crbegin(); it != edits.crend(); ++it) {
+            editor->gotoLine(int(it->line), int(it->column), false);
+            const int start = widget->textCursor().position();
+            if (it->removedLength > 0) {
+                editor->replace(it->removedLength, it->text);
+            } else {
+                editor->insert(it->text);
+            }
+            QTextCursor range(widget->document());
+            range.setPosition(start);
+            range.setPosition(widget->textCursor().position(), QTextCursor::KeepAnchor);
+            editedRanges.append(range);
+        }
+        for (const QTextCursor &range : std::as_const(editedRanges)) {
+            widget->setTextCursor(range);
+            widget->autoIndent();
+        }
+
+        if (!Core::DocumentManager::saveDocument(editor->document())) {
+            qCCritical(xmakeBuildSystemLog).noquote()
+                << "Changes to" << xmakeFile.toUserOutput() << "could not be saved.";
+            return false;
+        }
+        return true;
     }
 
     FilePaths XMakeBuildSystem::filesGeneratedFrom(const FilePath &sourceFile) const {
+        const GeneratedFilesIndex &index = m_generatedFilesIndex;
         FilePath project = projectDirectory();
         FilePath baseDirectory = sourceFile.parentDir();
 
         while (baseDirectory.isChildOf(project)) {
-            const FilePath xmakeListsTxt = baseDirectory.pathAppended(Constants::PROJECT_FILE_NAME);
-            if (xmakeListsTxt.exists()) {
+            const bool hasProjectFile = index.isValid
+                                        ? index.scriptDirectories.contains(baseDirectory)
+                                        : baseDirectory.pathAppended(Constants::PROJECT_FILE_NAME).exists();
+            if (hasProjectFile) {
                 break;
             }
             baseDirectory = baseDirectory.parentDir();
@@ -1026,25 +1129,40 @@ namespace XMakeProjectManager::Internal {
         if (sourceFile.suffix() == "ui") {
             const QString generatedFileName = "ui_" + sourceFile.completeBaseName() + ".h";
 
-            auto targetNode = this->project()->nodeForFilePath(sourceFile);
-            while (targetNode && !dynamic_cast<const XMakeTargetNode *>(targetNode)) {
-                targetNode = targetNode->parentFolderNode();
+            QString buildKey;
+            if (index.isValid) {
+                buildKey = index.targetForSource.value(sourceFile);
+            } else {
+                auto targetNode = this->project()->nodeForFilePath(sourceFile);
+                while (targetNode && !dynamic_cast<const XMakeTargetNode *>(targetNode)) {
+                    targetNode = targetNode->parentFolderNode();
+                }
+                if (targetNode) {
+                    buildKey = targetNode->buildKey();
+                }
             }
 
             FilePaths generatedFilePaths;
-            if (targetNode) {
-                const QString autogenSignature = targetNode->buildKey() + "_autogen/include";
+            if (!buildKey.isEmpty()) {
+                const QString autogenSignature = buildKey + "_autogen/include";
 
                 // If AUTOUIC reports the generated header file name, use that path
-                generatedFilePaths = this->project()->files(
-                    [autogenSignature, generatedFileName](const Node *n) {
-                        const FilePath filePath = n->filePath();
-                        if (!filePath.contains(autogenSignature)) {
-                            return false;
-                        }
+                if (index.isValid) {
+                    generatedFilePaths = Utils::filtered(index.autogenHeaders.values(generatedFileName),
+                                                         [&autogenSignature](const FilePath &filePath) {
+                                                             return filePath.contains(autogenSignature);
+                                                         });
+                } else {
+                    generatedFilePaths = this->project()->files(
+                        [autogenSignature, generatedFileName](const Node *n) {
+                            const FilePath filePath = n->filePath();
+                            if (!filePath.contains(autogenSignature)) {
+                                return false;
+                            }
 
-                        return Project::GeneratedFiles(n) && filePath.endsWith(generatedFileName);
-                    });
+                            return Project::GeneratedFiles(n) && filePath.endsWith(generatedFileName);
+                        });
+                }
             }
 
             if (generatedFilePaths.empty()) {
@@ -1062,6 +1180,56 @@ namespace XMakeProjectManager::Internal {
         return {};
     }
 
+    void XMakeBuildSystem::updateGeneratedFilesIndex() {
+        GeneratedFilesIndex index;
+
+        for (const XMakeFileInfo &info : std::as_const(m_xmakeFiles)) {
+            if (info.path.fileName() == Constants::PROJECT_FILE_NAME) {
+                index.scriptDirectories.insert(info.path.parentDir());
+            }
+        }
+
+        for (const XMakeBuildTarget &target : std::as_const(m_buildTargets)) {
+            if (filteredOutTarget(target)) {
+                continue;
+            }
+            for (const FilePath &sourceFile : target.sourceFiles) {
+                if (!index.targetForSource.contains(sourceFile)) {
+                    index.targetForSource.insert(sourceFile, target.title);
+                }
+            }
+        }
+
+        const FilePaths autogenHeaders = project()->files([](const Node *n) {
+                                                              return Project::GeneratedFiles(n)
+                                                                     && n->filePath().contains("_autogen/include");
+                                                          });
+        for (const FilePath &header : autogenHeaders) {
+            index.autogenHeaders.insert(header.fileName(), header);
+        }
+
+        index.isValid = true;
+        m_generatedFilesIndex = std::move(index);
+    }
+
+    void XMakeBuildSystem::updateTargetIndex() {
+        auto index = std::make_shared<QList<TargetIndexEntry>>();
+        index->reserve(m_buildTargets.size());
+        for (const XMakeBuildTarget &target : std::as_const(m_buildTargets)) {
+            if (filteredOutTarget(target)) {
+                continue;
+            }
+            TargetIndexEntry entry;
+            entry.title = target.title;
+            entry.targetType = target.targetType;
+            if (!target.backtrace.isEmpty() && target.targetType != UtilityType) {
+                entry.definition = {target.backtrace.last().path, target.backtrace.last().line};
+            }
+            index->append(std::move(entry));
+        }
+        m_targetIndex = std::move(index);
+    }
+
     QString XMakeBuildSystem::reparseParametersString(int reparseFlags) {
         QString result;
         if (reparseFlags == REPARSE_DEFAULT) {
@@ -1173,11 +1341,48 @@ namespace XMakeProjectManager::Internal {
 
     void XMakeBuildSystem::buildXMakeTarget(const QString &buildTarget) {
         QTC_ASSERT(!buildTarget.isEmpty(), return );
+        buildXMakeTargets({buildTarget});
+    }
+
+    void XMakeBuildSystem::buildXMakeTargets(const QStringList &buildTargets) {
+        QTC_ASSERT(!buildTargets.isEmpty(), return );
         if (ProjectExplorerPlugin::saveModifiedFiles()) {
-            xmakeBuildConfiguration()->buildTarget(buildTarget);
+            xmakeBuildConfiguration()->buildTargets(buildTargets);
         }
     }
 
+    std::optional<XMakeBuildSystem::BuildFileTarget> XMakeBuildSystem::buildFileTarget(
+        const FilePath &sourceFile) const {
+        const auto it = m_buildFileTargets.constFind(sourceFile);
+        if (it == m_buildFileTargets.cend()) {
+            return std::nullopt;
+        }
+        return *it;
+    }
+
+    void XMakeBuildSystem::updateBuildFileTargets() {
+        m_buildFileTargets.clear();
+        const ProjectNode *root = project()->rootProjectNode();
+        if (!root) {
+            return;
+        }
+        root->forEachGenericNode([this](const Node *node) {
+                                     const FileNode *fileNode = node->asFileNode();
+                                     if (!fileNode || fileNode->fileType() != FileType::Source) {
+                                         return;
+                                     }
+                                     const auto targetNode = dynamic_cast<const XMakeTargetNode *>(
+                                         fileNode->parentProjectNode());
+                                     if (!targetNode) {
+                                         return;
+                                     }
+                                     m_buildFileTargets.insert(fileNode->filePath(),
+                                                               {targetNode->displayName(),
+                                                                targetNode->filePath(),
+                                                                targetNode->buildDirectory()});
+                                 });
+    }
+
     bool XMakeBuildSystem::persistXMakeState() {
         BuildDirParameters parameters(this);
         QTC_ASSERT(parameters.isValid(), return false);
@@ -1238,6 +1443,8 @@ namespace XMakeProjectManager::Internal {
             }
 
             if (m_combinedScanAndParseResult) {
+                releaseScanWatcher();
+                m_scannedFiles.clear();
                 updateProjectData();
                 m_currentGuard.markAsSuccess();
 
@@ -1286,6 +1493,50 @@ namespace XMakeProjectManager::Internal {
                                 });
     }
 
+    static size_t projectPartHash(const RawProjectPart &rpp) {
+        size_t seed = 0;
+        seed = qHash(rpp.displayName, seed);
+        seed = qHash(rpp.projectFile, seed);
+        seed = qHash(rpp.projectFileLine, seed);
+        seed = qHash(rpp.projectFileColumn, seed);
+        seed = qHash(rpp.callGroupId, seed);
+        seed = qHash(rpp.buildSystemTarget, seed);
+        seed = qHash(int(rpp.buildTargetType), seed);
+        seed = qHash(rpp.selectedForBuilding, seed);
+        seed = qHash(int(rpp.qtVersion), seed);
+        seed = qHash(rpp.files, seed);
+        seed = qHash(rpp.precompiledHeaders, seed);
+        seed = qHash(rpp.includedFiles, seed);
+        seed = qHash(rpp.flagsForC.commandLineFlags, seed);
+        seed = qHash(rpp.flagsForCxx.commandLineFlags, seed);
+        for (const HeaderPath &headerPath : rpp.headerPaths) {
+            seed = qHash(headerPath.path, seed);
+            seed = qHash(int(headerPath.type), seed);
+        }
+        for (const Macro &macro : rpp.projectMacros) {
+            seed = qHash(macro.key, seed);
+            seed = qHash(macro.value, seed);
+            seed = qHash(int(macro.type), seed);
+        }
+        return seed;
+    }
+
+    // Everything outside the project parts that ends up in the C++ code model
+    static size_t codeModelContextHash(const QtSupport::CppKitInfo &kitInfo,
+                                       const Environment &environment) {
+        size_t seed = 0;
+        seed = qHash(int(kitInfo.projectPartQtVersion), seed);
+        if (kitInfo.cToolchain) {
+            seed = qHash(kitInfo.cToolchain->id(), seed);
+        }
+        if (kitInfo.cxxToolchain) {
+            seed = qHash(kitInfo.cxxToolchain->id(), seed);
+        }
+        seed = qHash(kitInfo.sysRootPath, seed);
+        seed = qHash(environment.toStringList(), seed);
+        return seed;
+    }
+
     void XMakeBuildSystem::updateProjectData() {
         qCDebug(xmakeBuildSystemLog) << "Updating XMake project data";
 
@@ -1343,13 +1594,23 @@ namespace XMakeProjectManager::Internal {
                                 }
                             }
                         });
+                    updateBuildFileTargets();
                 }
             }
         }
 
+        bool extraCompilersChanged = false;
         {
-            qDeleteAll(m_extraCompilers);
+            updateGeneratedFilesIndex();
+
+            const QList<ExtraCompiler *> oldExtraCompilers = m_extraCompilers;
             m_extraCompilers = findExtraCompilers();
+            extraCompilersChanged = m_extraCompilers != oldExtraCompilers;
+
+            const QSet<ExtraCompiler *> reused = Utils::toSet(m_extraCompilers);
+            qDeleteAll(Utils::filtered(oldExtraCompilers, [&reused](ExtraCompiler *ec) {
+                                           return !reused.contains(ec);
+                                       }));
             qCDebug(xmakeBuildSystemLog) << "Extra compilers created.";
         }
 
@@ -1404,36 +1665,41 @@ namespace XMakeProjectManager::Internal {
             }
         }
 
-        m_cppCodeModelUpdater->update({ p, kitInfo, buildConfiguration()->environment(), rpps },
-                                      m_extraCompilers);
-
-        {
-            const bool mergedHeaderPathsAndQmlImportPaths = kit()->value(
-                QtSupport::Constants::KIT_HAS_MERGED_HEADER_PATHS_WITH_QML_IMPORT_PATHS, false).toBool();
-            QStringList extraHeaderPaths;
-            QList<QByteArray> moduleMappings;
-            for (const RawProjectPart &rpp : std::as_const(rpps)) {
-                FilePath moduleMapFile = buildConfiguration()->buildDirectory()
-                    .pathAppended("qml_module_mappings/" + rpp.buildSystemTarget);
-                if (expected_str<QByteArray> content = moduleMapFile.fileContents()) {
-                    auto lines = content->split('\n');
-                    for (const QByteArray &line : lines) {
-                        if (!line.isEmpty()) {
-                            moduleMappings.append(line.simplified());
-                        }
-                    }
-                }
+        const Environment environment = buildConfiguration()->environment();
+        QHash<QString, size_t> projectPartHashes;
+        for (const RawProjectPart &rpp : std::as_const(rpps)) {
+            projectPartHashes.insert(rpp.displayName, projectPartHash(rpp));
+        }
+        projectPartHashes.insert(QString(), codeModelContextHash(kitInfo, environment));
 
-                if (mergedHeaderPathsAndQmlImportPaths) {
-                    for (const auto &headerPath : rpp.headerPaths) {
-                        if (headerPath.type == HeaderPathType::User || headerPath.type == HeaderPathType::System) {
-                            extraHeaderPaths.append(headerPath.path);
-                        }
-                    }
-                }
+        int addedParts = 0;
+        int changedParts = 0;
+        for (auto it = projectPartHashes.cbegin(); it != projectPartHashes.cend(); ++it) {
+            const auto oldIt = m_projectPartHashes.constFind(it.key());
+            if (oldIt == m_projectPartHashes.cend()) {
+                ++addedParts;
+            } else if (*oldIt != it.value()) {
+                ++changedParts;
             }
-            updateQmlJSCodeModel(extraHeaderPaths, moduleMappings);
         }
+        int removedParts = 0;
+        for (auto it = m_projectPartHashes.cbegin(); it != m_projectPartHashes.cend(); ++it) {
+            if (!projectPartHashes.contains(it.key())) {
+                ++removedParts;
+            }
+        }
+
+        qCDebug(xmakeBuildSystemLog) << "Project parts added:" << addedParts
+                                     << "removed:" << removedParts << "changed:" << changedParts;
+
+        if (addedParts || removedParts || changedParts || extraCompilersChanged) {
+            m_cppCodeModelUpdater->update({ p, kitInfo, environment, rpps }, m_extraCompilers);
+        } else {
+            qCDebug(xmakeBuildSystemLog) << "Project parts unchanged, skipping C++ code model update.";
+        }
+        m_projectPartHashes = std::move(projectPartHashes);
+
+        startQmlJSCodeModelUpdate(rpps);
         updateInitialXMakeExpandableVars();
 
         emit buildConfiguration()->buildTypeChanged();
@@ -1443,13 +1709,164 @@ namespace XMakeProjectManager::Internal {
 
     void XMakeBuildSystem::handleTreeScanningFinished() {
         TreeScanner::Result result = m_treeScanner.release();
-        m_allFiles = result.folderNode;
+
+        // Replace everything below the scanned directory, keep the rest of the last result
+        for (auto it = m_scannedFiles.begin(); it != m_scannedFiles.end();) {
+            if (it.key().isChildOf(m_scanDirectory)) {
+                it = m_scannedFiles.erase(it);
+            } else {
+                ++it;
+            }
+        }
+        for (const FileNode *fn : std::as_const(result.allFiles)) {
+            m_scannedFiles.insert(fn->filePath(), fn->fileType());
+        }
         qDeleteAll(result.allFiles);
 
+        if (!m_pendingScanDirectories.isEmpty()) {
+            startTreeScan();
+            return;
+        }
         updateFileSystemNodes();
     }
 
+    // Upper bound of directories watched for the fallback scan, inotify watches and kqueue
+    // descriptors are a per user resource shared with everything else
+    const int MAX_SCAN_WATCHED_DIRECTORIES = 2048;
+
+    // Lists the directories below the roots breadth first, so that the top levels are
+    // watched when there are more directories than the budget. The subtrees below the
+    // budget are not descended into.
+    static void collectScanDirectories(QPromise<XMakeBuildSystem::ScanDirectories> &promise,
+                                       const QList<FilePath> &roots,
+                                       const FilePath &buildDirectory,
+                                       int budget) {
+        XMakeBuildSystem::ScanDirectories result;
+        QList<FilePath> pending = roots;
+        for (qsizetype i = 0; i < pending.size(); ++i) {
+            if (promise.isCanceled()) {
+                return;
+            }
+            const FilePath dir = pending.at(i);
+            // A removed directory is covered by the change reported for its parent
+            if (!dir.exists()) {
+                continue;
+            }
+            if (result.watched.size() >= budget) {
+                result.unwatched.append(dir);
+                continue;
+            }
+            result.watched.append(dir.path());
+            const FilePaths subDirectories = dir.dirEntries(QDir::Dirs | QDir::NoDotAndDotDot);
+            for (const FilePath &subDir : subDirectories) {
+                if (subDir != buildDirectory) {
+                    pending.append(subDir);
+                }
+            }
+        }
+        promise.addResult(result);
+    }
+
+    static bool isBelowAny(const FilePath &path, const QList<FilePath> &roots) {
+        return Utils::anyOf(roots, [&path](const FilePath &root) {
+                                return path == root || path.isChildOf(root);
+                            });
+    }
+
+    // Watches are registered before the scan, a change during the scan is not missed
+    void XMakeBuildSystem::startScanDirectoriesCollection() {
+        const QList<FilePath> roots = m_pendingScanDirectories;
+        int budget = MAX_SCAN_WATCHED_DIRECTORIES;
+        if (m_scanWatcher) {
+            const QStringList watched = m_scanWatcher->directoryPaths();
+            budget -= int(std::count_if(watched.cbegin(), watched.cend(), [&roots](const QString &dir) {
+                              return !isBelowAny(FilePath::fromString(dir), roots);
+                          }));
+        }
+
+        m_scanDirectoriesFuture.cancel();
+        m_scanDirectoriesFuture = Utils::asyncRun(ProjectExplorerPlugin::sharedThreadPool(),
+                                                  collectScanDirectories,
+                                                  roots,
+                                                  m_parameters.buildDirectory,
+                                                  std::max(budget, 0));
+        Utils::onResultReady(m_scanDirectoriesFuture, this,
+                             [this, roots](const ScanDirectories &directories) {
+                                 updateScanWatcher(directories, roots);
+                                 startTreeScan();
+                             });
+    }
+
+    void XMakeBuildSystem::updateScanWatcher(const ScanDirectories &directories,
+                                             const QList<FilePath> &roots) {
+        if (!m_scanWatcher) {
+            m_scanWatcher = std::make_unique<FileSystemWatcher>();
+            connect(m_scanWatcher.get(), &FileSystemWatcher::directoryChanged,
+                    this, [this](const QString &directory) {
+                        m_dirtyScanDirectories.insert(FilePath::fromString(directory));
+                    });
+        }
+
+        // Only the part of the watched set below the rescanned directories changes
+        const QSet<QString> newWatched = Utils::toSet(directories.watched);
+        const QSet<QString> watched = Utils::toSet(m_scanWatcher->directoryPaths());
+        const QStringList removed = Utils::filtered(Utils::toList(watched),
+                                                    [&roots, &newWatched](const QString &dir) {
+                                                        return !newWatched.contains(dir)
+                                                               && isBelowAny(FilePath::fromString(dir),
+                                                                             roots);
+                                                    });
+        const QStringList added = Utils::toList(newWatched - watched);
+        if (!removed.isEmpty()) {
+            m_scanWatcher->removeDirectories(removed);
+        }
+        if (!added.isEmpty()) {
+            m_scanWatcher->addDirectories(added, FileSystemWatcher::WatchAllChanges);
+        }
+
+        for (auto it = m_unwatchedScanDirectories.begin(); it != m_unwatchedScanDirectories.end();) {
+            if (isBelowAny(*it, roots)) {
+                it = m_unwatchedScanDirectories.erase(it);
+            } else {
+                ++it;
+            }
+        }
+        for (const FilePath &dir : directories.unwatched) {
+            m_unwatchedScanDirectories.insert(dir);
+        }
+        if (!directories.unwatched.isEmpty()) {
+            qCDebug(xmakeBuildSystemLog) << directories.unwatched.size()
+                                         << "directories are rescanned on every fallback scan,"
+                                         << "the watched directories are over budget";
+        }
+    }
+
+    void XMakeBuildSystem::releaseScanWatcher() {
+        // Without a watcher the next fallback scan crawls the whole project again
+        m_scanDirectoriesFuture.cancel();
+        m_pendingScanDirectories.clear();
+        m_scanWatcher.reset();
+        m_dirtyScanDirectories.clear();
+        m_unwatchedScanDirectories.clear();
+    }
+
+    void XMakeBuildSystem::startTreeScan() {
+        QTC_ASSERT(!m_pendingScanDirectories.isEmpty(), return);
+        m_scanDirectory = m_pendingScanDirectories.takeFirst();
+
+        qCDebug(xmakeBuildSystemLog) << "Starting TreeScanner on" << m_scanDirectory;
+        if (m_treeScanner.asyncScanForFiles(m_scanDirectory)) {
+            Core::ProgressManager::addTask(m_treeScanner.future(),
+                                           Tr::tr("Scan \"%1\" project tree")
+                                           .arg(project()->displayName()),
+                                           "XMake.Scan.Tree");
+        }
+    }
+
     void XMakeBuildSystem::updateFileSystemNodes() {
+        m_generatedFilesIndex = {};
+        m_buildFileTargets.clear();
+
         auto newRoot = std::make_unique<XMakeProjectNode>(m_parameters.sourceDirectory);
         newRoot->setDisplayName(m_parameters.sourceDirectory.fileName());
 
@@ -1463,8 +1880,13 @@ namespace XMakeProjectManager::Internal {
             addXMakeLists(newRoot.get(), std::move(fileNodes));
         }
 
-        if (m_allFiles) {
-            addFileSystemNodes(newRoot.get(), m_allFiles);
+        if (!m_scannedFiles.isEmpty()) {
+            std::vector<std::unique_ptr<FileNode>> fileNodes;
+            fileNodes.reserve(m_scannedFiles.size());
+            for (auto it = m_scannedFiles.cbegin(); it != m_scannedFiles.cend(); ++it) {
+                fileNodes.emplace_back(std::make_unique<FileNode>(it.key(), it.value()));
+            }
+            addFileSystemNodes(newRoot.get(), projectDirectory(), std::move(fileNodes));
         }
         setRootProjectNode(std::move(newRoot));
 
@@ -1478,13 +1900,36 @@ namespace XMakeProjectManager::Internal {
 
     void XMakeBuildSystem::updateFallbackProjectData() {
         qCDebug(xmakeBuildSystemLog) << "Updating fallback XMake project data";
-        qCDebug(xmakeBuildSystemLog) << "Starting TreeScanner";
         QTC_CHECK(m_treeScanner.isFinished());
-        if (m_treeScanner.asyncScanForFiles(projectDirectory())) {
-            Core::ProgressManager::addTask(m_treeScanner.future(),
-                                           Tr::tr("Scan \"%1\" project tree")
-                                           .arg(project()->displayName()),
-                                           "XMake.Scan.Tree");
+
+        const FilePath projectDir = projectDirectory();
+        if (!m_scanWatcher) {
+            m_scannedFiles.clear();
+            m_pendingScanDirectories = { projectDir };
+        } else {
+            // Rescan the changed directories and the subtrees that are not watched
+            QList<FilePath> dirtyDirectories = Utils::toList(std::exchange(m_dirtyScanDirectories, {})
+                                                             + m_unwatchedScanDirectories);
+            if (dirtyDirectories.isEmpty()) {
+                qCDebug(xmakeBuildSystemLog) << "Reusing the previous TreeScanner result";
+                updateFileSystemNodes();
+                return;
+            }
+            // Parents sort before their children, which are covered by them
+            Utils::sort(dirtyDirectories);
+            m_pendingScanDirectories.clear();
+            for (const FilePath &dir : std::as_const(dirtyDirectories)) {
+                if (!isBelowAny(dir, m_pendingScanDirectories)) {
+                    m_pendingScanDirectories.append(dir);
+                }
+            }
+        }
+
+        // Projects on remote devices are crawled again every time
+        if (projectDir.needsDevice()) {
+            startTreeScan();
+        } else {
+            startScanDirectoriesCollection();
         }
     }
 
@@ -1576,6 +2021,7 @@ namespace XMakeProjectManager::Internal {
                                                   return result;
                                               });
             m_buildTargets += m_reader.takeBuildTargets(errorMessage);
+            updateTargetIndex();
             m_xmakeFiles = m_reader.takeXMakeFileInfos(errorMessage);
             setupXMakeSymbolsHash();
 
@@ -1911,6 +2357,9 @@ namespace XMakeProjectManager::Internal {
                                      << "stopping parsing run!";
         m_reader.stop();
         m_reader.resetData();
+
+        // Another build configuration may feed the code model until this one is active again
+        m_projectPartHashes.clear();
     }
 
     void XMakeBuildSystem::becameDirty() {
@@ -2051,6 +2500,48 @@ namespace XMakeProjectManager::Internal {
         return m_buildTargets;
     }
 
+    XMakeBuildSystem::TargetIndex XMakeBuildSystem::targetIndex() const {
+        return m_targetIndex;
+    }
+
+    // Returns the targets containing one of the files plus all targets depending on them.
+    // Returns std::nullopt, meaning all targets, if a file is not a source of any target.
+    // That covers project scripts and configuration files, and headers, which may be
+    // included from anywhere.
+    std::optional<QStringList> XMakeBuildSystem::affectedBuildTargets(const QSet<FilePath> &files) const {
+        QSet<QString> affected;
+        QSet<FilePath> unmatched = files;
+        QHash<QString, QStringList> dependents;
+        for (const XMakeBuildTarget &target : m_buildTargets) {
+            for (const QString &dependency : target.dependencies) {
+                dependents[dependency].append(target.title);
+            }
+            for (const FilePath &source : target.sourceFiles) {
+                if (files.contains(source)) {
+                    affected.insert(target.title);
+                    unmatched.remove(source);
+                }
+            }
+        }
+        if (!unmatched.isEmpty()) {
+            return std::nullopt;
+        }
+
+        QStringList pending(affected.cbegin(), affected.cend());
+        while (!pending.isEmpty()) {
+            const QString target = pending.takeLast();
+            for (const QString &dependent : dependents.value(target)) {
+                if (Utils::insert(affected, dependent)) {
+                    pending.append(dependent);
+                }
+            }
+        }
+
+        QStringList result(affected.cbegin(), affected.cend());
+        result.sort();
+        return result;
+    }
+
     bool XMakeBuildSystem::filteredOutTarget(const XMakeBuildTarget &target) {
         return target.title.endsWith("_autogen") ||
                target.title.endsWith("_autogen_timestamp_deps");
@@ -2140,8 +2631,13 @@ namespace XMakeProjectManager::Internal {
 
         qCDebug(xmakeBuildSystemLog) << "Finding Extra Compilers: Got factories.";
 
-        const QSet<QString> fileExtensions = Utils::transform<QSet>(factories,
-                                                                    &ExtraCompilerFactory::sourceTag);
+        QHash<QString, ExtraCompilerFactory *> factoryForExtension;
+        for (ExtraCompilerFactory *factory : factories) {
+            if (!factoryForExtension.contains(factory->sourceTag())) {
+                factoryForExtension.insert(factory->sourceTag(), factory);
+            }
+        }
+        const QSet<QString> fileExtensions = Utils::toSet(factoryForExtension.keys());
 
         qCDebug(xmakeBuildSystemLog) << "Finding Extra Compilers: Got file extensions:"
                                      << fileExtensions;
@@ -2158,15 +2654,17 @@ namespace XMakeProjectManager::Internal {
 
         qCDebug(xmakeBuildSystemLog) << "Finding Extra Compilers: Got list of files to check.";
 
+        // Keep the extra compilers of the previous run whose source and targets did not change
+        QHash<FilePath, ExtraCompiler *> previousExtraCompilers;
+        for (ExtraCompiler *ec : std::as_const(m_extraCompilers)) {
+            previousExtraCompilers.insert(ec->source(), ec);
+        }
+
         // Generate the necessary information:
         for (const FilePath &file : fileList) {
             qCDebug(xmakeBuildSystemLog)
                 << "Finding Extra Compilers: Processing" << file.toUserOutput();
-            ExtraCompilerFactory *factory = Utils::findOrDefault(factories,
-                                                                 [&file](const ExtraCompilerFactory *f) {
-                                                                     return file.endsWith(
-                                                                         '.' + f->sourceTag());
-                                                                 });
+            ExtraCompilerFactory *factory = factoryForExtension.value(file.suffix());
             QTC_ASSERT(factory, continue);
 
             FilePaths generated = filesGeneratedFrom(file);
@@ -2176,7 +2674,12 @@ namespace XMakeProjectManager::Internal {
                 continue;
             }
 
-            extraCompilers.append(factory->create(p, file, generated));
+            ExtraCompiler *previous = previousExtraCompilers.value(file);
+            if (previous && previous->targets() == generated) {
+                extraCompilers.append(previous);
+            } else {
+                extraCompilers.append(factory->create(p, file, generated));
+            }
             qCDebug(xmakeBuildSystemLog)
                 << "Finding Extra Compilers:     done with" << file.toUserOutput();
         }
@@ -2186,8 +2689,104 @@ namespace XMakeProjectManager::Internal {
         return extraCompilers;
     }
 
-    void XMakeBuildSystem::updateQmlJSCodeModel(const QStringList &extraHeaderPaths,
-                                                const QList<QByteArray> &moduleMappings) {
+    static QList<QByteArray> readQmlModuleMappingFile(const FilePath &moduleMapFile) {
+        QList<QByteArray> result;
+        if (expected_str<QByteArray> content = moduleMapFile.fileContents()) {
+            const QList<QByteArray> lines = content->split('\n');
+            for (const QByteArray &line : lines) {
+                if (!line.isEmpty()) {
+                    result.append(line.simplified());
+                }
+            }
+        }
+        return result;
+    }
+
+    void XMakeBuildSystem::startQmlJSCodeModelUpdate(const RawProjectParts &rpps) {
+        if (!QmlJS::ModelManagerInterface::instance()) {
+            return;
+        }
+
+        m_qmlCodeModelFuture.cancel();
+
+        const FilePath buildDirectory = buildConfiguration()->buildDirectory();
+        const bool mergedHeaderPathsAndQmlImportPaths = kit()->value(
+            QtSupport::Constants::KIT_HAS_MERGED_HEADER_PATHS_WITH_QML_IMPORT_PATHS, false).toBool();
+        const QStringList imports = { configurationFromXMake().stringValueOf("QML_IMPORT_PATH"),
+                                      kit()->value(QtSupport::Constants::KIT_QML_IMPORT_PATH).toString() };
+
+        // Reading the module mapping files and collecting the header paths is done off the
+        // GUI thread, only the final ProjectInfo is assembled in updateQmlJSCodeModel().
+        m_qmlCodeModelFuture = Utils::asyncRun(
+            ProjectExplorerPlugin::sharedThreadPool(),
+            [rpps, buildDirectory, mergedHeaderPathsAndQmlImportPaths, imports,
+             cache = m_qmlModuleMappingCache](QPromise<QmlCodeModelData> &promise) {
+                QmlCodeModelData data;
+
+                for (const QString &importValue : imports) {
+                    const QStringList importList = XMakeConfigItem::xmakeSplitValue(importValue);
+                    for (const QString &import : importList) {
+                        data.importPaths.append(FilePath::fromUserInput(import));
+                    }
+                }
+
+                for (const RawProjectPart &rpp : rpps) {
+                    if (promise.isCanceled()) {
+                        return;
+                    }
+
+                    const FilePath moduleMapFile = buildDirectory.pathAppended(
+                        "qml_module_mappings/" + rpp.buildSystemTarget);
+                    if (!data.moduleMappingCache.contains(moduleMapFile)) {
+                        const QDateTime lastModified = moduleMapFile.lastModified();
+                        if (lastModified.isValid()) {
+                            QmlModuleMappingFile entry = cache.value(moduleMapFile);
+                            if (entry.lastModified != lastModified) {
+                                entry.lastModified = lastModified;
+                                entry.lines = readQmlModuleMappingFile(moduleMapFile);
+                            }
+                            data.moduleMappingCache.insert(moduleMapFile, entry);
+
+                            for (const QByteArray &mm : std::as_const(entry.lines)) {
+                                const QList<QByteArray> kvPair = mm.split('=');
+                                if (kvPair.size() != 2) {
+                                    continue;
+                                }
+                                const QString from = QString::fromUtf8(kvPair.at(0).trimmed());
+                                const QString to = QString::fromUtf8(kvPair.at(1).trimmed());
+                                if (from.isEmpty() || to.isEmpty() || from == to) {
+                                    continue;
+                                }
+                                // The QML code-model does not support sub-projects, so if there are
+                                // multiple mappings for a single module, choose the shortest one.
+                                const auto it = data.moduleMappings.constFind(from);
+                                if (it == data.moduleMappings.cend() || to.size() < it->size()) {
+                                    data.moduleMappings.insert(from, to);
+                                }
+                            }
+                        }
+                    }
+
+                    if (mergedHeaderPathsAndQmlImportPaths) {
+                        for (const auto &headerPath : rpp.headerPaths) {
+                            if (headerPath.type == HeaderPathType::User
+                                || headerPath.type == HeaderPathType::System) {
+                                data.importPaths.append(FilePath::fromString(headerPath.path));
+                            }
+                        }
+                    }
+                }
+
+                promise.addResult(data);
+            });
+
+        Utils::onResultReady(m_qmlCodeModelFuture, this, [this](const QmlCodeModelData &data) {
+                                 m_qmlModuleMappingCache = data.moduleMappingCache;
+                                 updateQmlJSCodeModel(data);
+                             });
+    }
+
+    void XMakeBuildSystem::updateQmlJSCodeModel(const QmlCodeModelData &data) {
         QmlJS::ModelManagerInterface *modelManager = QmlJS::ModelManagerInterface::instance();
 
         if (!modelManager) {
@@ -2199,40 +2798,14 @@ namespace XMakeProjectManager::Internal {
             = modelManager->defaultProjectInfoForProject(p, p->files(Project::HiddenRccFolders));
 
         projectInfo.importPaths.clear();
-
-        auto addImports = [&projectInfo](const QString &imports) {
-            const QStringList importList = XMakeConfigItem::xmakeSplitValue(imports);
-            for (const QString &import : importList) {
-                projectInfo.importPaths.maybeInsert(FilePath::fromUserInput(import), QmlJS::Dialect::Qml);
-            }
-        };
-
-        const XMakeConfig &cm = configurationFromXMake();
-        addImports(cm.stringValueOf("QML_IMPORT_PATH"));
-        addImports(kit()->value(QtSupport::Constants::KIT_QML_IMPORT_PATH).toString());
-
-        for (const QString &extraHeaderPath : extraHeaderPaths) {
-            projectInfo.importPaths.maybeInsert(FilePath::fromString(extraHeaderPath),
-                                                QmlJS::Dialect::Qml);
+        for (const FilePath &importPath : data.importPaths) {
+            projectInfo.importPaths.maybeInsert(importPath, QmlJS::Dialect::Qml);
         }
-
-        for (const QByteArray &mm : moduleMappings) {
-            auto kvPair = mm.split('=');
-            if (kvPair.size() != 2) {
-                continue;
-            }
-            QString from = QString::fromUtf8(kvPair.at(0).trimmed());
-            QString to = QString::fromUtf8(kvPair.at(1).trimmed());
-            if (!from.isEmpty() && !to.isEmpty() && from != to) {
-                // The QML code-model does not support sub-projects, so if there are multiple mappings for a single module,
-                // choose the shortest one.
-                if (projectInfo.moduleMappings.contains(from)) {
-                    if (to.size() < projectInfo.moduleMappings.value(from).size()) {
-                        projectInfo.moduleMappings.insert(from, to);
-                    }
-                } else {
-                    projectInfo.moduleMappings.insert(from, to);
-                }
+        // Merge into the default mappings, keeping the shortest one for a module
+        for (auto it = data.moduleMappings.cbegin(); it != data.moduleMappings.cend(); ++it) {
+            const auto existing = projectInfo.moduleMappings.constFind(it.key());
+            if (existing == projectInfo.moduleMappings.cend() || it->size() < existing->size()) {
+                projectInfo.moduleMappings.insert(it.key(), it.value());
             }
         }
 
@@ -2242,7 +2815,7 @@ namespace XMakeProjectManager::Internal {
     }
 
     void XMakeBuildSystem::updateInitialXMakeExpandableVars() {
-        const XMakeConfig &cm = configurationFromXMake();
+        const IndexedXMakeConfig &cm = configurationFromXMake();
         const XMakeConfig &initialConfig =
             xmakeBuildConfiguration()->initialXMakeArguments.xmakeConfiguration();
 
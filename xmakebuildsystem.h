@@ -10,8 +10,12 @@
 #include <projectexplorer/buildconfiguration.h>
 #include <projectexplorer/buildsystem.h>
 
+#include <utils/link.h>
 #include <utils/temporarydirectory.h>
 
+#include <QDateTime>
+#include <QFuture>
+
 namespace ProjectExplorer {
     class ExtraCompiler;
     class FolderNode;
@@ -19,6 +23,7 @@ namespace ProjectExplorer {
 }
 
 namespace Utils {
+    class FileSystemWatcher;
     class Process;
     class Link;
 }
@@ -60,6 +65,19 @@ public:
                             const Utils::FilePath &oldFilePath,
                             const Utils::FilePath &newFilePath) final;
 
+            // Edits to project scripts made by addFiles(), removeFiles() and renameFile()
+            // between these calls are collected per script and written in one go when the
+            // outermost transaction ends.
+            void beginProjectFileEdits();
+            bool endProjectFileEdits();
+
+            struct ProjectFileEdit {
+                long line = -1;   // 1-based
+                long column = -1; // 0-based
+                int removedLength = 0;
+                QString text;
+            };
+
             Utils::FilePaths filesGeneratedFrom(const Utils::FilePath &sourceFile) const final;
             QString name() const final {
                 return QLatin1String("xmake");
@@ -77,11 +95,37 @@ public:
 
             // Context menu actions:
             void buildXMakeTarget(const QString &buildTarget);
+            void buildXMakeTargets(const QStringList &buildTargets);
+
+            // Build File, based on the target nodes of the last successful parse:
+            struct BuildFileTarget {
+                QString targetName;
+                Utils::FilePath sourceDirectory;
+                Utils::FilePath buildDirectory;
+            };
+            std::optional<BuildFileTarget> buildFileTarget(const Utils::FilePath &sourceFile) const;
+
+            // Directories of the fallback scan, collected off the GUI thread
+            struct ScanDirectories {
+                QStringList watched;
+                QList<Utils::FilePath> unwatched; // Subtrees over the watch budget
+            };
 
             // Queries:
             const QList<ProjectExplorer::BuildTargetInfo> appTargets() const;
             QStringList buildTargetTitles() const;
             const QList<XMakeBuildTarget> &buildTargets() const;
+
+            // What the locator needs to know about a build target, without the code model data
+            struct TargetIndexEntry {
+                QString title;
+                TargetType targetType = UtilityType;
+                Utils::Link definition; // Empty for utility targets and targets without backtrace
+            };
+            using TargetIndex = std::shared_ptr<const QList<TargetIndexEntry>>;
+            // Rebuilt after each successful parse, safe to read from other threads
+            TargetIndex targetIndex() const;
+            std::optional<QStringList> affectedBuildTargets(const QSet<Utils::FilePath> &files) const;
             ProjectExplorer::DeploymentData deploymentDataFromFile() const;
 
             XMakeBuildConfiguration *xmakeBuildConfiguration() const;
@@ -106,7 +150,7 @@ public:
             QString xmakeBuildType() const;
             ProjectExplorer::BuildConfiguration::BuildType buildType() const;
 
-            XMakeConfig configurationFromXMake() const;
+            const IndexedXMakeConfig &configurationFromXMake() const;
             XMakeConfig configurationChanges() const;
 
             QStringList configurationChangesArguments(bool initialParameters = false) const;
@@ -158,6 +202,9 @@ private:
 
             bool addSrcFiles(ProjectExplorer::Node *context, const Utils::FilePaths &filePaths,
                              Utils::FilePaths *);
+            bool addSrcFilesToTarget(const QString &targetName,
+                                     const Utils::FilePath &projDir,
+                                     const Utils::FilePaths &filePaths);
             bool addTsFiles(ProjectExplorer::Node *context, const Utils::FilePaths &filePaths,
                             Utils::FilePaths *);
 
@@ -187,6 +234,11 @@ private:
 
             // Treescanner states:
             void handleTreeScanningFinished();
+            void startScanDirectoriesCollection();
+            void updateScanWatcher(const ScanDirectories &directories,
+                                   const QList<Utils::FilePath> &roots);
+            void releaseScanWatcher();
+            void startTreeScan();
 
             // Combining Treescanner and Parser states:
             void combineScanAndParse(bool restoredFromBackup);
@@ -197,8 +249,24 @@ private:
             void updateProjectData();
             void updateFallbackProjectData();
             QList<ProjectExplorer::ExtraCompiler *> findExtraCompilers();
-            void updateQmlJSCodeModel(const QStringList &extraHeaderPaths,
-                                      const QList<QByteArray> &moduleMappings);
+            void updateGeneratedFilesIndex();
+            void updateTargetIndex();
+            void updateBuildFileTargets();
+
+            // Contents of a qml_module_mappings/<target> file, reused while its mtime is unchanged
+            struct QmlModuleMappingFile {
+                QDateTime lastModified;
+                QList<QByteArray> lines;
+            };
+            using QmlModuleMappingCache = QHash<Utils::FilePath, QmlModuleMappingFile>;
+
+            struct QmlCodeModelData {
+                Utils::FilePaths importPaths;
+                QHash<QString, QString> moduleMappings;
+                QmlModuleMappingCache moduleMappingCache;
+            };
+            void startQmlJSCodeModelUpdate(const ProjectExplorer::RawProjectParts &rpps);
+            void updateQmlJSCodeModel(const QmlCodeModelData &data);
             void updateInitialXMakeExpandableVars();
 
             void updateFileSystemNodes();
@@ -227,9 +295,34 @@ private:
             };
             std::optional<ProjectFileArgumentPosition> projectFileArgumentPosition(
                 const QString &targetName, const QString &fileName);
+            QList<ProjectFileArgumentPosition> projectFileArgumentPositions(
+                const QString &targetName, const QString &fileName);
+
+            std::optional<cmListFile> xmakeListFileForEditing(const Utils::FilePath &xmakeFile);
+            void queueProjectFileEdit(const Utils::FilePath &xmakeFile, const ProjectFileEdit &edit);
+            bool applyProjectFileEdits(const Utils::FilePath &xmakeFile, QList<ProjectFileEdit> edits);
+
+            struct PendingSourceFiles {
+                QString targetName;
+                Utils::FilePath projectDirectory;
+                Utils::FilePaths filePaths;
+            };
+            int m_projectFileEditDepth = 0;
+            QList<PendingSourceFiles> m_pendingSourceFiles;
+            QHash<Utils::FilePath, QList<ProjectFileEdit>> m_projectFileEdits;
+            QHash<Utils::FilePath, cmListFile> m_editedXMakeListFiles;
 
             ProjectExplorer::TreeScanner m_treeScanner;
-            std::shared_ptr<ProjectExplorer::FolderNode> m_allFiles;
+            // Result of the fallback tree scans, refreshed below the directories reported
+            // by m_scanWatcher instead of crawling the whole project again
+            QHash<Utils::FilePath, ProjectExplorer::FileType> m_scannedFiles;
+            Utils::FilePath m_scanDirectory;
+            QList<Utils::FilePath> m_pendingScanDirectories;
+            QSet<Utils::FilePath> m_dirtyScanDirectories;
+            // Subtrees over the watch budget, rescanned on every fallback scan
+            QSet<Utils::FilePath> m_unwatchedScanDirectories;
+            std::unique_ptr<Utils::FileSystemWatcher> m_scanWatcher;
+            QFuture<ScanDirectories> m_scanDirectoriesFuture;
             QHash<QString, bool> m_mimeBinaryCache;
 
             bool m_waitingForParse = false;
@@ -240,8 +333,12 @@ private:
             ParseGuard m_currentGuard;
 
             ProjectExplorer::ProjectUpdater *m_cppCodeModelUpdater = nullptr;
+            QHash<QString, size_t> m_projectPartHashes; // by RawProjectPart::displayName
+            QFuture<QmlCodeModelData> m_qmlCodeModelFuture;
+            QmlModuleMappingCache m_qmlModuleMappingCache;
             QList<ProjectExplorer::ExtraCompiler *> m_extraCompilers;
             QList<XMakeBuildTarget> m_buildTargets;
+            TargetIndex m_targetIndex;
             QSet<XMakeFileInfo> m_xmakeFiles;
             QHash<QString, Utils::Link> m_xmakeSymbolsHash;
             QHash<QString, Utils::Link> m_dotXMakeFilesHash;
@@ -252,6 +349,17 @@ private:
 
             QHash<QString, ProjectFileArgumentPosition> m_filesToBeRenamed;
 
+            // Lookup tables for filesGeneratedFrom(), rebuilt once per successful parse
+            struct GeneratedFilesIndex {
+                bool isValid = false;
+                QSet<Utils::FilePath> scriptDirectories;
+                QHash<Utils::FilePath, QString> targetForSource;
+                QMultiHash<QString, Utils::FilePath> autogenHeaders; // by file name
+            };
+            GeneratedFilesIndex m_generatedFilesIndex;
+
+            QHash<Utils::FilePath, BuildFileTarget> m_buildFileTargets; // by source file
+
             // Parsing state:
             BuildDirParameters m_parameters;
             int m_reparseParameters = REPARSE_DEFAULT;
@@ -263,7 +371,7 @@ private:
             std::unique_ptr<Utils::Process> m_ctestProcess;
             QList<ProjectExplorer::TestCaseInfo> m_testNames;
 
-            XMakeConfig m_configurationFromXMake;
+            IndexedXMakeConfig m_configurationFromXMake;
             XMakeConfig m_configurationChanges;
 
             QString m_error;
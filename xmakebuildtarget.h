@@ -38,6 +38,7 @@ public:
     Utils::FilePath makeCommand;
     Utils::FilePaths libraryDirectories;
     Utils::FilePaths sourceFiles;
+    QStringList dependencies; // Titles of the targets this target depends on
 
     Backtrace backtrace;
 
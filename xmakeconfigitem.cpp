@@ -67,6 +67,59 @@ QString XMakeConfig::expandedValueOf(const ProjectExplorer::Kit *k, const QByteA
     return QString();
 }
 
+// --------------------------------------------------------------------
+// IndexedXMakeConfig:
+// --------------------------------------------------------------------
+
+IndexedXMakeConfig::IndexedXMakeConfig(const XMakeConfig &config)
+    : m_config(config)
+{
+    m_index.reserve(m_config.size());
+    // Backwards, so that the first item of a duplicate key ends up in the index
+    for (qsizetype i = m_config.size() - 1; i >= 0; --i)
+        m_index.insert(m_config.at(i).key, i);
+}
+
+const XMakeConfigItem *IndexedXMakeConfig::item(const QByteArray &key) const
+{
+    const auto it = m_index.constFind(key);
+    return it == m_index.cend() ? nullptr : &m_config.at(*it);
+}
+
+QByteArray IndexedXMakeConfig::valueOf(const QByteArray &key) const
+{
+    const XMakeConfigItem *i = item(key);
+    return i ? i->value : QByteArray();
+}
+
+QString IndexedXMakeConfig::stringValueOf(const QByteArray &key) const
+{
+    return QString::fromUtf8(valueOf(key));
+}
+
+FilePath IndexedXMakeConfig::filePathValueOf(const QByteArray &key) const
+{
+    return FilePath::fromUtf8(valueOf(key));
+}
+
+QString IndexedXMakeConfig::expandedValueOf(const ProjectExplorer::Kit *k,
+                                            const QByteArray &key) const
+{
+    const XMakeConfigItem *i = item(key);
+    return i ? i->expandedValue(k) : QString();
+}
+
+void IndexedXMakeConfig::insertOrReplace(const XMakeConfigItem &item)
+{
+    const auto it = m_index.constFind(item.key);
+    if (it != m_index.cend()) {
+        m_config[*it] = item;
+        return;
+    }
+    m_index.insert(item.key, m_config.size());
+    m_config.append(item);
+}
+
 static QString between(const QString::ConstIterator it1, const QString::ConstIterator it2)
 {
     QString result;
@@ -128,7 +181,7 @@ QStringList XMakeConfigItem::xmakeSplitValue(const QString &in, bool keepEmpty)
     return newArgs;
 }
 
-XMakeConfigItem::Type XMakeConfigItem::typeStringToType(const QByteArray &type)
+XMakeConfigItem::Type XMakeConfigItem::typeStringToType(QByteArrayView type)
 {
     if (type == "BOOL")
         return XMakeConfigItem::BOOL;
@@ -270,28 +323,6 @@ XMakeConfigItem XMakeConfigItem::fromString(const QString &s)
     return item;
 }
 
-static QByteArray trimXMakeCacheLine(const QByteArray &in) {
-    int start = 0;
-    while (start < in.size() && (in.at(start) == ' ' || in.at(start) == '\t'))
-        ++start;
-
-    return in.mid(start, in.size() - start - 1);
-}
-
-static QByteArrayList splitXMakeCacheLine(const QByteArray &line) {
-    const int colonPos = line.indexOf(':');
-    if (colonPos < 0)
-        return QByteArrayList();
-
-    const int equalPos = line.indexOf('=', colonPos + 1);
-    if (equalPos < colonPos)
-        return QByteArrayList();
-
-    return QByteArrayList() << line.mid(0, colonPos)
-                            << line.mid(colonPos + 1, equalPos - colonPos - 1)
-                            << line.mid(equalPos + 1);
-}
-
 static XMakeConfigItem setItemFromString(const QString &input)
 {
     return XMakeConfigItem::fromString(input);
@@ -343,46 +374,76 @@ XMakeConfig XMakeConfig::fromArguments(const QStringList &list, QStringList &unk
     return Utils::filtered(result, [](const XMakeConfigItem &item) { return !item.key.isEmpty(); });
 }
 
+// Scans the cache in place, from a memory mapping when possible. Only keys, values and
+// documentation lines are copied out of the file.
 XMakeConfig XMakeConfig::fromFile(const Utils::FilePath &cacheFile, QString *errorMessage)
 {
-    XMakeConfig result;
     QFile cache(cacheFile.toString());
-    if (!cache.open(QIODevice::ReadOnly | QIODevice::Text)) {
+    if (!cache.open(QIODevice::ReadOnly)) {
         if (errorMessage)
             *errorMessage = Tr::tr("Failed to open %1 for reading.").arg(cacheFile.toUserOutput());
         return XMakeConfig();
     }
 
+    QByteArray contents;
+    const qint64 size = cache.size();
+    const char *begin = size > 0 ? reinterpret_cast<const char *>(cache.map(0, size)) : nullptr;
+    const char *end = begin ? begin + size : nullptr;
+    if (!begin) {
+        contents = cache.readAll();
+        begin = contents.constData();
+        end = begin + contents.size();
+    }
+
+    XMakeConfig result;
     QSet<QByteArray> advancedSet;
-    QMap<QByteArray, QByteArray> valuesMap;
+    QHash<QByteArray, QByteArray> valuesMap;
     QByteArray documentation;
-    while (!cache.atEnd()) {
-        const QByteArray line = trimXMakeCacheLine(cache.readLine());
+    // XMake writes the cache sorted by key, so sorting is usually not needed
+    bool isSorted = true;
+
+    for (const char *pos = begin; pos < end;) {
+        const char *lineEnd = std::find(pos, end, '\n');
+        const char *lineStart = pos;
+        pos = lineEnd == end ? end : lineEnd + 1;
+
+        while (lineStart < lineEnd && (*lineStart == ' ' || *lineStart == '\t'))
+            ++lineStart;
+        if (lineEnd > lineStart && lineEnd[-1] == '\r')
+            --lineEnd;
+        const QByteArrayView line(lineStart, lineEnd);
 
         if (line.isEmpty() || line.startsWith('#'))
             continue;
 
         if (line.startsWith("//")) {
-            documentation = line.mid(2);
+            documentation = line.sliced(2).toByteArray();
             continue;
         }
 
-        const QByteArrayList pieces = splitXMakeCacheLine(line);
-        if (pieces.isEmpty())
+        const char *colon = std::find(lineStart, lineEnd, ':');
+        if (colon == lineEnd)
+            continue;
+        const char *equal = std::find(colon + 1, lineEnd, '=');
+        if (equal == lineEnd)
             continue;
 
-        QTC_ASSERT(pieces.size() == 3, continue);
-        const QByteArray &key = pieces.at(0);
-        const QByteArray &type = pieces.at(1);
-        const QByteArray &value = pieces.at(2);
+        const QByteArrayView key(lineStart, colon);
+        const QByteArrayView type(colon + 1, equal);
+        const QByteArrayView value(equal + 1, lineEnd);
 
         if (key.endsWith("-ADVANCED") && value == "1") {
-            advancedSet.insert(key.left(key.size() - 9 /* "-ADVANCED" */));
-        } else if (key.endsWith("-STRINGS") && XMakeConfigItem::typeStringToType(type) == XMakeConfigItem::INTERNAL) {
-            valuesMap[key.left(key.size() - 8) /* "-STRINGS" */] = value;
+            advancedSet.insert(key.chopped(9 /* "-ADVANCED" */).toByteArray());
+        } else if (key.endsWith("-STRINGS")
+                   && XMakeConfigItem::typeStringToType(type) == XMakeConfigItem::INTERNAL) {
+            valuesMap.insert(key.chopped(8 /* "-STRINGS" */).toByteArray(), value.toByteArray());
         } else {
-            XMakeConfigItem::Type t = XMakeConfigItem::typeStringToType(type);
-            result << XMakeConfigItem(key, t, documentation, value);
+            if (isSorted && !result.isEmpty() && key < QByteArrayView(result.last().key))
+                isSorted = false;
+            result << XMakeConfigItem(key.toByteArray(),
+                                      XMakeConfigItem::typeStringToType(type),
+                                      documentation,
+                                      value.toByteArray());
         }
     }
 
@@ -391,15 +452,18 @@ XMakeConfig XMakeConfig::fromFile(const Utils::FilePath &cacheFile, QString *err
         XMakeConfigItem &item = result[i];
         item.isAdvanced = advancedSet.contains(item.key);
 
-        if (valuesMap.contains(item.key)) {
-            item.values = XMakeConfigItem::xmakeSplitValue(QString::fromUtf8(valuesMap[item.key]));
+        const auto values = valuesMap.constFind(item.key);
+        if (values != valuesMap.cend()) {
+            item.values = XMakeConfigItem::xmakeSplitValue(QString::fromUtf8(*values));
         } else if (item.key  == "XMAKE_BUILD_TYPE") {
             // WA for known options
             item.values << "" << "Debug" << "Release" << "MinSizeRel" << "RelWithDebInfo";
         }
     }
 
-    return Utils::sorted(std::move(result), &XMakeConfigItem::less);
+    if (!isSorted)
+        Utils::sort(result, &XMakeConfigItem::less);
+    return result;
 }
 
 QString XMakeConfigItem::toString(const Utils::MacroExpander *expander) const
@@ -476,6 +540,7 @@ size_t qHash(const XMakeConfigItem &it)
 
 #if WITH_TESTS
 
+#include <QTemporaryDir>
 #include <QTest>
 
 namespace XMakeProjectManager::Internal {
@@ -487,6 +552,14 @@ class XMakeConfigTest final : public QObject
 private slots:
     void testXMakeSplitValue_data();
     void testXMakeSplitValue();
+
+    void testIndexedXMakeConfig();
+
+    void benchmarkValueOf_data();
+    void benchmarkValueOf();
+
+    void testFromFile();
+    void benchmarkFromFile();
 };
 
 void XMakeConfigTest::testXMakeSplitValue_data()
@@ -543,6 +616,126 @@ void XMakeConfigTest::testXMakeSplitValue()
     QCOMPARE(expectedOutput, realOutput);
 }
 
+void XMakeConfigTest::testIndexedXMakeConfig()
+{
+    const XMakeConfig config = {XMakeConfigItem("A", "1"),
+                                XMakeConfigItem("B", "2"),
+                                XMakeConfigItem("A", "3")};
+    IndexedXMakeConfig indexed(config);
+
+    QCOMPARE(indexed.valueOf("A"), config.valueOf("A"));
+    QCOMPARE(indexed.valueOf("B"), config.valueOf("B"));
+    QCOMPARE(indexed.valueOf("C"), config.valueOf("C"));
+    QVERIFY(!indexed.contains("C"));
+    QCOMPARE(indexed.config(), config);
+
+    indexed.insertOrReplace(XMakeConfigItem("B", "4"));
+    indexed.insertOrReplace(XMakeConfigItem("C", "5"));
+    QCOMPARE(indexed.valueOf("B"), QByteArray("4"));
+    QCOMPARE(indexed.valueOf("C"), QByteArray("5"));
+    QCOMPARE(indexed.size(), 4);
+    QCOMPARE(indexed.config().last().key, QByteArray("C"));
+}
+
+// A configuration of the size of the cache of a larger project
+static XMakeConfig largeConfig()
+{
+    XMakeConfig config;
+    for (int i = 0; i < 3000; ++i) {
+        config.append(XMakeConfigItem("VARIABLE_" + QByteArray::number(i),
+                                      "value_" + QByteArray::number(i)));
+    }
+    return config;
+}
+
+void XMakeConfigTest::benchmarkValueOf_data()
+{
+    QTest::addColumn<bool>("indexed");
+
+    QTest::newRow("XMakeConfig") << false;
+    QTest::newRow("IndexedXMakeConfig") << true;
+}
+
+void XMakeConfigTest::benchmarkValueOf()
+{
+    QFETCH(bool, indexed);
+
+    const XMakeConfig config = largeConfig();
+    const IndexedXMakeConfig indexedConfig(config);
+    const QByteArrayList keys = {"VARIABLE_0", "VARIABLE_1500", "VARIABLE_2999", "MISSING"};
+
+    QByteArray value;
+    if (indexed) {
+        QBENCHMARK {
+            for (const QByteArray &key : keys)
+                value = indexedConfig.valueOf(key);
+        }
+    } else {
+        QBENCHMARK {
+            for (const QByteArray &key : keys)
+                value = config.valueOf(key);
+        }
+    }
+    QVERIFY(value.isEmpty());
+}
+
+void XMakeConfigTest::testFromFile()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const FilePath cacheFile = FilePath::fromString(dir.path()) / "XMakeCache.txt";
+    QVERIFY(cacheFile.writeFileContents("# This is the XMakeCache file.\n"
+                                        "\n"
+                                        "//Choose the type of build\n"
+                                        "XMAKE_BUILD_TYPE:STRING=Debug\n"
+                                        "//Path to a program.\n"
+                                        "XMAKE_AR:FILEPATH=/usr/bin/ar\r\n"
+                                        "XMAKE_AR-ADVANCED:INTERNAL=1\n"
+                                        "OPTION:STRING=b\n"
+                                        "OPTION-STRINGS:INTERNAL=a;b;c\n"
+                                        "  INDENTED:BOOL=ON\n"
+                                        "NO_NEWLINE_AT_END:STRING=value"));
+
+    QString errorMessage;
+    const XMakeConfig config = XMakeConfig::fromFile(cacheFile, &errorMessage);
+    QVERIFY(errorMessage.isEmpty());
+
+    QCOMPARE(transform<QByteArrayList>(config, &XMakeConfigItem::key),
+             QByteArrayList({"INDENTED", "NO_NEWLINE_AT_END", "OPTION", "XMAKE_AR",
+                             "XMAKE_BUILD_TYPE"}));
+    const IndexedXMakeConfig indexed(config);
+    QCOMPARE(indexed.valueOf("XMAKE_AR"), QByteArray("/usr/bin/ar"));
+    QVERIFY(indexed.item("XMAKE_AR")->isAdvanced);
+    QCOMPARE(indexed.item("XMAKE_AR")->documentation, QByteArray("Path to a program."));
+    QCOMPARE(indexed.item("XMAKE_AR")->type, XMakeConfigItem::FILEPATH);
+    QCOMPARE(indexed.item("OPTION")->values, QStringList({"a", "b", "c"}));
+    QCOMPARE(indexed.item("INDENTED")->type, XMakeConfigItem::BOOL);
+    QCOMPARE(indexed.valueOf("NO_NEWLINE_AT_END"), QByteArray("value"));
+}
+
+void XMakeConfigTest::benchmarkFromFile()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const FilePath cacheFile = FilePath::fromString(dir.path()) / "XMakeCache.txt";
+
+    QByteArray contents = "# This is the XMakeCache file.\n\n";
+    for (int i = 0; i < 10000; ++i) {
+        const QByteArray key = "VARIABLE_" + QByteArray::number(i).rightJustified(5, '0');
+        contents += "//Documentation of " + key + "\n";
+        contents += key + ":FILEPATH=/some/path/to/a/file_" + QByteArray::number(i) + "\n";
+        if (i % 10 == 0)
+            contents += key + "-ADVANCED:INTERNAL=1\n";
+    }
+    QVERIFY(cacheFile.writeFileContents(contents));
+
+    XMakeConfig config;
+    QBENCHMARK {
+        config = XMakeConfig::fromFile(cacheFile, nullptr);
+    }
+    QCOMPARE(config.size(), 10000);
+}
+
 QObject *createXMakeConfigTest()
 {
     return new XMakeConfigTest();
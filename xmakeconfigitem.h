@@ -6,6 +6,7 @@
 #include "xmake_global.h"
 
 #include <QByteArray>
+#include <QHash>
 #include <QObject>
 #include <QStringList>
 
@@ -32,7 +33,7 @@ public:
     XMakeConfigItem(const QByteArray &k, const QByteArray &v);
 
     static QStringList xmakeSplitValue(const QString &in, bool keepEmpty = false);
-    static Type typeStringToType(const QByteArray &typeString);
+    static Type typeStringToType(QByteArrayView typeString);
     static QString typeToTypeString(const Type t);
     static std::optional<bool> toBool(const QString &value);
     bool isNull() const { return key.isEmpty(); }
@@ -79,6 +80,40 @@ public:
     QString expandedValueOf(const ProjectExplorer::Kit *k, const QByteArray &key) const;
 };
 
+// An XMakeConfig with O(1) lookup by key. Iterates in the order of the items, and like the
+// XMakeConfig lookups the first item with a key wins.
+class XMAKE_EXPORT IndexedXMakeConfig
+{
+public:
+    IndexedXMakeConfig() = default;
+    IndexedXMakeConfig(const XMakeConfig &config);
+
+    const XMakeConfig &config() const { return m_config; }
+    operator const XMakeConfig &() const { return m_config; }
+
+    XMakeConfig::const_iterator begin() const { return m_config.cbegin(); }
+    XMakeConfig::const_iterator end() const { return m_config.cend(); }
+    XMakeConfig::const_iterator cbegin() const { return m_config.cbegin(); }
+    XMakeConfig::const_iterator cend() const { return m_config.cend(); }
+    qsizetype size() const { return m_config.size(); }
+    bool isEmpty() const { return m_config.isEmpty(); }
+
+    bool contains(const QByteArray &key) const { return m_index.contains(key); }
+    const XMakeConfigItem *item(const QByteArray &key) const;
+
+    QByteArray valueOf(const QByteArray &key) const;
+    QString stringValueOf(const QByteArray &key) const;
+    Utils::FilePath filePathValueOf(const QByteArray &key) const;
+    QString expandedValueOf(const ProjectExplorer::Kit *k, const QByteArray &key) const;
+
+    // Replaces the first item with the key of item, or appends it
+    void insertOrReplace(const XMakeConfigItem &item);
+
+private:
+    XMakeConfig m_config;
+    QHash<QByteArray, qsizetype> m_index;
+};
+
 #ifdef WITH_TESTS
 namespace Internal { QObject *createXMakeConfigTest(); }
 #endif
@@ -6,12 +6,11 @@
 
 #include "xmakeautocompleter.h"
 #include "xmakebuildsystem.h"
+#include "xmakefileast.h"
 #include "xmakefilecompletionassist.h"
 #include "xmakeindenter.h"
 #include "xmakeprojectconstants.h"
 
-#include "3rdparty/xmake/cmListFileCache.h"
-
 #include <coreplugin/actionmanager/actioncontainer.h>
 #include <coreplugin/actionmanager/actionmanager.h>
 #include <coreplugin/coreplugintr.h>
@@ -165,41 +164,19 @@ private:
         return chr.isLetterOrNumber() || chr == '_' || chr == '-';
     }
 
-    static QHash<QString, Link> getLocalSymbolsHash(const QByteArray &content,
-                                                    const FilePath &filePath, QString &projectName) {
-        cmListFile xmakeListFile;
-        if (!content.isEmpty()) {
-            std::string errorString;
-            const std::string fileName = "buffer";
-            if (!xmakeListFile.ParseString(content.toStdString(), fileName, errorString)) {
-                return {};
-            }
+    static std::optional<Link> localSymbolLink(XMakeFileAst *ast, const QString &name,
+                                               long beforeLine, const FilePath &filePath) {
+        const std::optional<XMakeFileAst::Function> definition = ast->definition(name, beforeLine);
+        if (!definition) {
+            return {};
         }
+        const cmListFileArgument &arg = definition->function.Arguments().front();
 
-        QHash<QString, Link> hash;
-        for (const auto &func : xmakeListFile.Functions) {
-            if (func.LowerCaseName() == "project" && func.Arguments().size() > 0) {
-                projectName = QString::fromUtf8(func.Arguments()[0].Value);
-                continue;
-            }
-
-            if (func.LowerCaseName() != "function" && func.LowerCaseName() != "macro"
-                && func.LowerCaseName() != "set" && func.LowerCaseName() != "option") {
-                continue;
-            }
-
-            if (func.Arguments().size() == 0) {
-                continue;
-            }
-            auto arg = func.Arguments()[0];
-
-            Link link;
-            link.targetFilePath = filePath;
-            link.targetLine = arg.Line;
-            link.targetColumn = arg.Column - 1;
-            hash.insert(QString::fromUtf8(arg.Value), link);
-        }
-        return hash;
+        Link link;
+        link.targetFilePath = filePath;
+        link.targetLine = definition->line(arg);
+        link.targetColumn = arg.Column - 1;
+        return link;
     }
 
     void XMakeEditorWidget::findLinkAt(const QTextCursor &cursor,
@@ -323,11 +300,10 @@ private:
         const int funcStart = findFunctionStart();
         const int funcEnd = findFunctionEnd();
 
-        // Resolve local variables and functions
-        QString projectName;
-        auto hash = getLocalSymbolsHash(textDocument()->textAt(0, funcEnd + 1).toUtf8(),
-                                        textDocument()->filePath(),
-                                        projectName);
+        // Resolve local variables and functions defined before the current function
+        XMakeFileAst *ast = XMakeFileAst::forDocument(document());
+        const long funcEndLine = document()->findBlock(funcEnd).blockNumber() + 1;
+        const QString projectName = ast->projectName(funcEndLine);
         if (!projectName.isEmpty()) {
             buffer.replace("${PROJECT_NAME}", projectName);
         }
@@ -400,8 +376,8 @@ private:
             buffer = buffer.mid(2, buffer.size() - 3);
         }
 
-        if (hash.contains(buffer)) {
-            link = hash.value(buffer);
+        if (auto localLink = localSymbolLink(ast, buffer, funcEndLine, textDocument()->filePath())) {
+            link = *localLink;
             addTextStartEndToLink(link);
             return processLinkCallback(link);
         }
@@ -451,6 +427,28 @@ public:
         void operateTooltip(TextEditorWidget *editorWidget, const QPoint &point) final;
     };
 
+    // Shows the source of the local function, macro or variable definition
+    static QString localSymbolToolTip(QTextDocument *document, const QString &word) {
+        const std::optional<XMakeFileAst::Function> definition
+            = XMakeFileAst::forDocument(document)->definition(word);
+        if (!definition) {
+            return {};
+        }
+
+        const int maxLines = 10;
+        QStringList lines;
+        QTextBlock block = document->findBlockByNumber(definition->line() - 1);
+        for (long line = definition->line(); line <= definition->lineEnd() && block.isValid();
+             ++line, block = block.next()) {
+            if (lines.size() == maxLines) {
+                lines << "...";
+                break;
+            }
+            lines << block.text();
+        }
+        return QString("```\n%1\n```").arg(lines.join('\n'));
+    }
+
     const XMakeKeywords &XMakeHoverHandler::keywords() const {
         if (m_keywords.functions.isEmpty()) {
             if (auto tool = XMakeToolManager::defaultProjectOrDefaultXMakeTool()) {
@@ -499,6 +497,8 @@ public:
         m_helpToolTip.clear();
         if (!helpFile.isEmpty()) {
             m_helpToolTip = XMakeToolManager::toolTipForRstHelpFile(helpFile);
+        } else if (!word.isEmpty()) {
+            m_helpToolTip = localSymbolToolTip(editorWidget->document(), word);
         }
 
         m_contextHelp = QVariant::fromValue(
@@ -0,0 +1,450 @@
+// Copyright (C) 2016 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only WITH Qt-GPL-exception-1.0
+
+#include "xmakefileast.h"
+
+#include <utils/qtcassert.h>
+
+#include <QTextBlock>
+#include <QTextDocument>
+
+#include <algorithm>
+
+namespace XMakeProjectManager::Internal {
+
+XMakeFileAst::XMakeFileAst(QTextDocument *document)
+    : QObject(document)
+    , m_document(document)
+    , m_blockCount(document->blockCount())
+    , m_revision(document->revision())
+{
+    connect(document, &QTextDocument::contentsChange, this, &XMakeFileAst::onContentsChange);
+}
+
+XMakeFileAst *XMakeFileAst::forDocument(QTextDocument *document)
+{
+    QTC_ASSERT(document, return nullptr);
+    if (auto ast = document->findChild<XMakeFileAst *>(QString(), Qt::FindDirectChildrenOnly))
+        return ast;
+    return new XMakeFileAst(document);
+}
+
+std::vector<XMakeFileAst::Function> XMakeFileAst::functions()
+{
+    update();
+
+    std::vector<Function> result;
+    result.reserve(m_entries.size());
+    for (const Entry &entry : m_entries)
+        result.push_back(entry.function);
+    return result;
+}
+
+std::vector<XMakeFileAst::Function> XMakeFileAst::functionsBefore(long line)
+{
+    update();
+
+    std::vector<Function> result;
+    for (const Entry &entry : m_entries) {
+        if (entry.function.lineEnd() > line)
+            break;
+        result.push_back(entry.function);
+    }
+    return result;
+}
+
+std::optional<XMakeFileAst::Function> XMakeFileAst::definition(const QString &name,
+                                                             long beforeLine)
+{
+    updateSymbols();
+
+    const auto it = m_definitions.constFind(name);
+    if (it == m_definitions.constEnd())
+        return {};
+    return lastBefore(*it, beforeLine);
+}
+
+QString XMakeFileAst::projectName(long beforeLine)
+{
+    updateSymbols();
+
+    const std::optional<Function> project = lastBefore(m_projects, beforeLine);
+    if (!project)
+        return {};
+    return QString::fromStdString(project->function.Arguments().front().Value);
+}
+
+std::optional<XMakeFileAst::Function> XMakeFileAst::lastBefore(const std::vector<size_t> &indexes,
+                                                             long line) const
+{
+    // The functions do not overlap, so they are sorted by their end line as well
+    const auto it = std::upper_bound(indexes.cbegin(), indexes.cend(), line,
+                                     [this](long line, size_t index) {
+                                         return line < m_entries[index].function.lineEnd();
+                                     });
+    if (it == indexes.cbegin())
+        return {};
+    return m_entries[*std::prev(it)].function;
+}
+
+void XMakeFileAst::onContentsChange(int position, int charsRemoved, int charsAdded)
+{
+    // The highlighter reports format changes, they do not bump the revision
+    if (charsRemoved == charsAdded && m_document->revision() == m_revision)
+        return;
+    m_revision = m_document->revision();
+
+    const int blockCount = m_document->blockCount();
+    const int delta = blockCount - m_blockCount;
+    m_blockCount = blockCount;
+
+    const QTextBlock first = m_document->findBlock(position);
+    const QTextBlock last = m_document->findBlock(position + charsAdded);
+    const int firstBlock = first.isValid() ? first.blockNumber() : blockCount - 1;
+    const int lastBlock = last.isValid() ? last.blockNumber() : blockCount - 1;
+
+    // Drop the functions touched by the change, move the ones after it. The lines in
+    // between get parsed again on the next query. Lines are parsed as a whole, so the
+    // functions sharing a line with a dropped one are dropped as well.
+    long dropFirst = firstBlock;
+    long dropLast = lastBlock - delta;
+    size_t keptBefore = 0;
+    while (keptBefore < m_entries.size()
+           && m_entries[keptBefore].function.lineEnd() - 1 < dropFirst) {
+        ++keptBefore;
+    }
+    size_t keptAfter = keptBefore;
+    while (keptAfter < m_entries.size() && m_entries[keptAfter].function.line() - 1 <= dropLast) {
+        dropLast = std::max(dropLast, m_entries[keptAfter].function.lineEnd() - 1);
+        ++keptAfter;
+    }
+    if (keptAfter > keptBefore)
+        dropFirst = std::min(dropFirst, m_entries[keptBefore].function.line() - 1);
+    while (keptBefore > 0 && m_entries[keptBefore - 1].function.lineEnd() - 1 >= dropFirst) {
+        --keptBefore;
+        dropFirst = m_entries[keptBefore].function.line() - 1;
+    }
+
+    m_entries.erase(m_entries.begin() + keptBefore, m_entries.begin() + keptAfter);
+    for (size_t i = keptBefore; i < m_entries.size(); ++i)
+        m_entries[i].function.lineOffset += delta;
+    m_symbolsDirty = true;
+
+    if (keptBefore == 0)
+        m_dirtyHead = true;
+    else
+        m_entries[keptBefore - 1].dirtyAfter = true;
+}
+
+void XMakeFileAst::update()
+{
+    const bool dirty = m_dirtyHead
+                       || std::any_of(m_entries.cbegin(), m_entries.cend(), [](const Entry &entry) {
+                              return entry.dirtyAfter;
+                          });
+    if (!dirty)
+        return;
+
+    std::vector<Entry> entries;
+    entries.reserve(m_entries.size());
+    const auto appendParsed = [&entries](std::vector<Entry> &&parsed) {
+        std::move(parsed.begin(), parsed.end(), std::back_inserter(entries));
+    };
+
+    // Parses the lines from the given block up to the kept function at index next.
+    // An unterminated bracket or string swallows the following functions in a full
+    // parse, then the rest of the document is parsed instead. Returns the index of
+    // the next kept function.
+    const auto parseGap = [this, &appendParsed](long firstBlock, size_t next) {
+        if (next < m_entries.size()) {
+            // Block numbers are 0-based, lines 1-based
+            const long lastBlock = m_entries[next].function.line() - 2;
+            bool unterminated = false;
+            std::vector<Entry> parsed = parseLines(firstBlock, lastBlock, &unterminated);
+            if (!unterminated) {
+                appendParsed(std::move(parsed));
+                return next;
+            }
+        }
+        appendParsed(parseLines(firstBlock, m_blockCount - 1));
+        return m_entries.size();
+    };
+
+    size_t i = 0;
+    if (m_dirtyHead) {
+        i = parseGap(0, 0);
+        m_dirtyHead = false;
+    }
+
+    while (i < m_entries.size()) {
+        Entry &entry = m_entries[i];
+        if (!entry.dirtyAfter) {
+            entries.push_back(std::move(entry));
+            ++i;
+            continue;
+        }
+        // The function is parsed again with the gap, a bracket comment or a string
+        // may start after it on its last line and continue into the gap
+        i = parseGap(entry.function.line() - 1, i + 1);
+    }
+
+    m_entries = std::move(entries);
+    m_symbolsDirty = true;
+}
+
+void XMakeFileAst::updateSymbols()
+{
+    update();
+    if (!m_symbolsDirty)
+        return;
+
+    m_definitions.clear();
+    m_projects.clear();
+    for (size_t i = 0; i < m_entries.size(); ++i) {
+        const cmListFileFunction &function = m_entries[i].function.function;
+        if (function.Arguments().empty())
+            continue;
+
+        const std::string &name = function.LowerCaseName();
+        if (name == "project") {
+            m_projects.push_back(i);
+        } else if (name == "function" || name == "macro" || name == "set" || name == "option") {
+            m_definitions[QString::fromStdString(function.Arguments().front().Value)].push_back(i);
+        }
+    }
+    m_symbolsDirty = false;
+}
+
+std::vector<XMakeFileAst::Entry> XMakeFileAst::parseLines(int firstBlock,
+                                                         int lastBlock,
+                                                         bool *unterminated) const
+{
+    if (firstBlock > lastBlock)
+        return {};
+
+    QString text;
+    QTextBlock block = m_document->findBlockByNumber(firstBlock);
+    for (int i = firstBlock; i <= lastBlock && block.isValid(); ++i, block = block.next()) {
+        text.append(block.text());
+        text.append('\n');
+    }
+
+    // On parse errors the functions before the error are kept. The rest of the lines
+    // are parsed again once they are edited.
+    cmListFile xmakeListFile;
+    std::string errorString;
+    xmakeListFile.ParseString(text.toUtf8().toStdString(), "buffer", errorString);
+    if (unterminated) {
+        *unterminated = errorString.find("unterminated bracket") != std::string::npos
+                        || errorString.find("unterminated string") != std::string::npos;
+    }
+
+    std::vector<Entry> entries;
+    entries.reserve(xmakeListFile.Functions.size());
+    for (cmListFileFunction &function : xmakeListFile.Functions)
+        entries.push_back({{std::move(function), firstBlock}, false});
+    return entries;
+}
+
+} // XMakeProjectManager::Internal
+
+#ifdef WITH_TESTS
+
+#include <QTest>
+#include <QTextCursor>
+
+namespace XMakeProjectManager::Internal {
+
+class XMakeFileAstTest final : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void testIncrementalUpdate_data();
+    void testIncrementalUpdate();
+    void testBrokenFunction();
+    void testSharedLine();
+    void testUnterminatedGap();
+    void testDefinitions();
+
+private:
+    static void compareWithFullParse(QTextDocument *document);
+};
+
+void XMakeFileAstTest::compareWithFullParse(QTextDocument *document)
+{
+    cmListFile xmakeListFile;
+    std::string errorString;
+    QVERIFY(xmakeListFile.ParseString(document->toPlainText().toUtf8().toStdString(),
+                                      "buffer",
+                                      errorString));
+
+    const std::vector<XMakeFileAst::Function> functions
+        = XMakeFileAst::forDocument(document)->functions();
+    QCOMPARE(functions.size(), xmakeListFile.Functions.size());
+    for (size_t i = 0; i < functions.size(); ++i) {
+        const XMakeFileAst::Function &actual = functions[i];
+        const cmListFileFunction &expected = xmakeListFile.Functions[i];
+        QCOMPARE(actual.function.OriginalName(), expected.OriginalName());
+        QCOMPARE(actual.line(), expected.Line());
+        QCOMPARE(actual.lineEnd(), expected.LineEnd());
+        QCOMPARE(actual.function.Arguments().size(), expected.Arguments().size());
+        for (size_t a = 0; a < expected.Arguments().size(); ++a) {
+            const cmListFileArgument &argument = actual.function.Arguments()[a];
+            QCOMPARE(argument.Value, expected.Arguments()[a].Value);
+            QCOMPARE(actual.line(argument), expected.Arguments()[a].Line);
+            QCOMPARE(argument.Column, expected.Arguments()[a].Column);
+        }
+    }
+}
+
+void XMakeFileAstTest::testIncrementalUpdate_data()
+{
+    QTest::addColumn<QString>("text");
+    QTest::addColumn<int>("position");
+    QTest::addColumn<int>("removed");
+    QTest::addColumn<QString>("inserted");
+
+    const QString text = "project(demo)\n"
+                         "\n"
+                         "# comment\n"
+                         "set(SOURCES\n"
+                         "    main.cpp\n"
+                         "    util.cpp)\n"
+                         "function(helper arg)\n"
+                         "  message(${arg})\n"
+                         "endfunction()\n"
+                         "option(WITH_TESTS \"Tests\" ON)\n";
+
+    QTest::newRow("insert line at start") << text << 0 << 0 << QString("\n");
+    QTest::newRow("insert function in gap") << text << 14 << 0 << QString("include(Foo)\n");
+    QTest::newRow("edit argument") << text << 30 << 4 << QString("other");
+    QTest::newRow("split function") << text << 38 << 0 << QString("\n\n");
+    QTest::newRow("join lines") << text << 13 << 2 << QString();
+    QTest::newRow("remove function") << text << 0 << 14 << QString();
+    QTest::newRow("edit last function") << text << int(text.size() - 4) << 2 << QString("OFF");
+    QTest::newRow("append") << text << int(text.size()) << 0 << QString("add_subdirectory(src)\n");
+    QTest::newRow("replace all") << text << 0 << int(text.size()) << QString("set(A B)\n");
+
+    const QString comment = "set(A B) #[[\n"
+                            "set(X Y)\n"
+                            "]]\n"
+                            "set(C D)\n";
+    QTest::newRow("edit comment after function") << comment << 17 << 1 << QString("Z");
+    QTest::newRow("edit function after comment") << comment << 29 << 1 << QString("E");
+}
+
+void XMakeFileAstTest::testIncrementalUpdate()
+{
+    QFETCH(QString, text);
+    QFETCH(int, position);
+    QFETCH(int, removed);
+    QFETCH(QString, inserted);
+
+    QTextDocument document(text);
+    compareWithFullParse(&document);
+
+    QTextCursor cursor(&document);
+    cursor.setPosition(position);
+    cursor.setPosition(position + removed, QTextCursor::KeepAnchor);
+    cursor.insertText(inserted);
+    compareWithFullParse(&document);
+}
+
+void XMakeFileAstTest::testBrokenFunction()
+{
+    QTextDocument document("set(A B)\nset(C D)\nset(E F)\n");
+    XMakeFileAst *ast = XMakeFileAst::forDocument(&document);
+    QCOMPARE(ast->functions().size(), size_t(3));
+
+    // The functions outside of the broken one are still known
+    QTextCursor cursor(&document);
+    cursor.setPosition(16);
+    cursor.deleteChar();
+    QCOMPARE(ast->functions().size(), size_t(2));
+    QCOMPARE(ast->functionsBefore(2).size(), size_t(1));
+
+    cursor.insertText(")");
+    compareWithFullParse(&document);
+}
+
+void XMakeFileAstTest::testSharedLine()
+{
+    QTextDocument document("set(A B)\nset(C\nD)\nset(E F)\n");
+    XMakeFileAst *ast = XMakeFileAst::forDocument(&document);
+    QCOMPARE(ast->functions().size(), size_t(3));
+
+    // "set(A B)set(C" shares a line until the line break is back
+    QTextCursor cursor(&document);
+    cursor.setPosition(8);
+    cursor.deleteChar();
+    ast->functions();
+
+    cursor.setPosition(15);
+    cursor.insertText(" E");
+    ast->functions();
+
+    cursor.setPosition(8);
+    cursor.insertText("\n");
+    compareWithFullParse(&document);
+}
+
+void XMakeFileAstTest::testUnterminatedGap()
+{
+    QTextDocument document("set(A B)\n\nset(C D)\nset(E F)\n");
+    XMakeFileAst *ast = XMakeFileAst::forDocument(&document);
+    QCOMPARE(ast->functions().size(), size_t(3));
+
+    // The opened bracket comment swallows the functions after it
+    QTextCursor cursor(&document);
+    cursor.setPosition(9);
+    cursor.insertText("#[[");
+    QCOMPARE(ast->functions().size(), size_t(1));
+
+    cursor.setPosition(21);
+    cursor.insertText("]]");
+    compareWithFullParse(&document);
+    QCOMPARE(ast->functions().size(), size_t(2));
+
+    // Same for a quoted argument
+    cursor.setPosition(9);
+    cursor.setPosition(23, QTextCursor::KeepAnchor);
+    cursor.insertText("set(Q \"");
+    QCOMPARE(ast->functions().size(), size_t(1));
+
+    cursor.insertText("\")");
+    compareWithFullParse(&document);
+}
+
+void XMakeFileAstTest::testDefinitions()
+{
+    QTextDocument document("project(demo)\n"
+                           "set(A 1)\n"
+                           "function(helper)\n"
+                           "endfunction()\n"
+                           "set(A 2)\n");
+    XMakeFileAst *ast = XMakeFileAst::forDocument(&document);
+
+    QCOMPARE(ast->projectName(), QString("demo"));
+    QCOMPARE(ast->projectName(0), QString());
+    QCOMPARE(ast->definition("helper")->line(), 3L);
+    QCOMPARE(ast->definition("A")->line(), 5L);
+    QCOMPARE(ast->definition("A", 4)->line(), 2L);
+    QVERIFY(!ast->definition("A", 1));
+    QVERIFY(!ast->definition("B"));
+
+    QTextCursor cursor(&document);
+    cursor.insertText("\n");
+    QCOMPARE(ast->definition("A")->line(), 6L);
+}
+
+QObject *createXMakeFileAstTest()
+{
+    return new XMakeFileAstTest;
+}
+
+} // XMakeProjectManager::Internal
+
+#endif
+
+#include "xmakefileast.moc"
@@ -0,0 +1,88 @@
+// Copyright (C) 2016 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only WITH Qt-GPL-exception-1.0
+
+#pragma once
+
+#include "3rdparty/xmake/cmListFileCache.h"
+
+#include <QHash>
+#include <QObject>
+
+#include <limits>
+#include <optional>
+#include <vector>
+
+QT_BEGIN_NAMESPACE
+class QTextDocument;
+QT_END_NAMESPACE
+
+namespace XMakeProjectManager::Internal {
+
+// The parsed function calls of an open XMake file. The tree is kept up to date
+// while the document is edited by parsing only the lines touched by a change.
+// Lives in the GUI thread, as a child of the document.
+class XMakeFileAst final : public QObject
+{
+    Q_OBJECT
+
+public:
+    struct Function
+    {
+        long line() const { return function.Line() + lineOffset; }
+        long lineEnd() const { return function.LineEnd() + lineOffset; }
+        long line(const cmListFileArgument &argument) const { return argument.Line + lineOffset; }
+
+        cmListFileFunction function;
+        // The parsed line numbers are relative, add the offset to get the document line
+        long lineOffset = 0;
+    };
+
+    static XMakeFileAst *forDocument(QTextDocument *document);
+
+    std::vector<Function> functions();
+    // The functions ending before the given 1-based line
+    std::vector<Function> functionsBefore(long line);
+
+    // The last function, macro, set() or option() call defining the name that ends
+    // before the given line. The name is the first argument of the call.
+    std::optional<Function> definition(const QString &name,
+                                       long beforeLine = std::numeric_limits<long>::max());
+    // The name given by the last project() call ending before the given line
+    QString projectName(long beforeLine = std::numeric_limits<long>::max());
+
+private:
+    explicit XMakeFileAst(QTextDocument *document);
+
+    struct Entry
+    {
+        Function function;
+        // The lines between this function and the next one need to be parsed
+        bool dirtyAfter = false;
+    };
+
+    void onContentsChange(int position, int charsRemoved, int charsAdded);
+    void update();
+    void updateSymbols();
+    // Sets unterminated if the lines end inside a bracket argument, bracket comment
+    // or quoted argument
+    std::vector<Entry> parseLines(int firstBlock, int lastBlock, bool *unterminated = nullptr) const;
+    std::optional<Function> lastBefore(const std::vector<size_t> &indexes, long line) const;
+
+    QTextDocument *m_document = nullptr;
+    std::vector<Entry> m_entries;
+    // The lines before the first function need to be parsed
+    bool m_dirtyHead = true;
+    int m_blockCount = 0;
+    int m_revision = -1;
+
+    // Indexes into m_entries, rebuilt on the first query after a change
+    QHash<QString, std::vector<size_t>> m_definitions;
+    std::vector<size_t> m_projects;
+    bool m_symbolsDirty = true;
+};
+
+#ifdef WITH_TESTS
+QObject *createXMakeFileAstTest();
+#endif
+
+} // XMakeProjectManager::Internal
@@ -7,12 +7,11 @@
 #include "xmakebuildtarget.h"
 #include "xmakebuildconfiguration.h"
 #include "xmakeconfigitem.h"
+#include "xmakefileast.h"
 #include "xmakeprojectconstants.h"
 #include "xmaketool.h"
 #include "xmaketoolmanager.h"
 
-#include "3rdparty/xmake/cmListFileCache.h"
-
 #include <projectexplorer/project.h>
 #include <projectexplorer/projectexplorerconstants.h>
 #include <projectexplorer/projectexplorericons.h>
@@ -26,9 +25,16 @@
 #include <texteditor/texteditorsettings.h>
 
 #include <utils/async.h>
+#include <utils/filesystemwatcher.h>
 #include <utils/fsengine/fileiconprovider.h>
 #include <utils/utilsicons.h>
 
+#include <QMutex>
+#include <QTextBlock>
+#include <QTextDocument>
+
+#include <optional>
+
 using namespace TextEditor;
 using namespace ProjectExplorer;
 using namespace Utils;
@@ -163,35 +169,178 @@ struct MarkDownAssitProposalItem : public AssistProposalItem
     Qt::TextFormat detailFormat() const override { return Qt::MarkdownText; }
 };
 
-template<typename T>
-static QList<AssistProposalItemInterface *> generateList(const T &words, const QIcon &icon)
+// One bit per ASCII letter, digit, '_' and '-' contained in the text
+static quint64 characterMask(const QString &text)
 {
-    return transform<QList>(words, [&icon](const QString &word) -> AssistProposalItemInterface * {
-        AssistProposalItem *item = new AssistProposalItem();
-        item->setText(word);
-        item->setIcon(icon);
-        return item;
-    });
+    quint64 mask = 0;
+    for (const QChar chr : text) {
+        const char16_t c = chr.toLower().unicode();
+        if (c >= 'a' && c <= 'z')
+            mask |= quint64(1) << (c - 'a');
+        else if (c >= '0' && c <= '9')
+            mask |= quint64(1) << (26 + c - '0');
+        else if (c == '_')
+            mask |= quint64(1) << 36;
+        else if (c == '-')
+            mask |= quint64(1) << 37;
+    }
+    return mask;
+}
+
+// The proposal model shows prefix matches, and fuzzy and infix matches for longer
+// prefixes. All of them contain the prefix characters in order.
+static bool matchesPrefix(const QString &text, const QString &prefix)
+{
+    qsizetype pos = 0;
+    for (const QChar chr : prefix) {
+        pos = text.indexOf(chr, pos, Qt::CaseInsensitive);
+        if (pos < 0)
+            return false;
+        ++pos;
+    }
+    return true;
 }
 
-static QList<AssistProposalItemInterface *> generateList(const QMap<QString, FilePath> &words,
-                                                         const QIcon &icon)
+template<typename T>
+static QList<AssistProposalItemInterface *> generateList(const T &words,
+                                                         const QIcon &icon,
+                                                         const QString &prefix)
 {
     QList<AssistProposalItemInterface *> list;
-    for (auto it = words.cbegin(); it != words.cend(); ++it) {
-        MarkDownAssitProposalItem *item = new MarkDownAssitProposalItem();
-        item->setText(it.key());
-        if (!it.value().isEmpty())
-            item->setDetail(XMakeToolManager::toolTipForRstHelpFile(it.value()));
+    for (const QString &word : words) {
+        if (!matchesPrefix(word, prefix))
+            continue;
+        AssistProposalItem *item = new AssistProposalItem();
+        item->setText(word);
         item->setIcon(icon);
         list << item;
     }
     return list;
 }
 
+// The words of one keyword category, prepared once and reused by all completion
+// requests until the words change. The keyword containers are implicitly shared, so
+// an unchanged category is detected without comparing its contents.
+template<typename Words>
+class ProposalPool
+{
+public:
+    QList<AssistProposalItemInterface *> items(const Words &words,
+                                               const QIcon &icon,
+                                               const QString &prefix)
+    {
+        // Only the matching is done under the lock, rendering the details can take a while
+        std::vector<Entry> matches;
+        {
+            QMutexLocker locker(&m_mutex);
+            if (m_words != words)
+                rebuild(words);
+
+            const quint64 prefixMask = characterMask(prefix);
+            for (const Entry &entry : m_entries) {
+                if ((entry.characters & prefixMask) == prefixMask
+                    && matchesPrefix(entry.text, prefix)) {
+                    matches.push_back(entry);
+                }
+            }
+        }
+
+        QList<AssistProposalItemInterface *> list;
+        list.reserve(qsizetype(matches.size()));
+        for (const Entry &entry : matches) {
+            AssistProposalItem *item = nullptr;
+            if constexpr (std::is_same_v<Words, QMap<QString, FilePath>>) {
+                item = new MarkDownAssitProposalItem();
+                if (!entry.helpFile.isEmpty())
+                    item->setDetail(XMakeToolManager::toolTipForRstHelpFile(entry.helpFile));
+            } else {
+                item = new AssistProposalItem();
+            }
+            item->setText(entry.text);
+            item->setIcon(icon);
+            list << item;
+        }
+        return list;
+    }
+
+private:
+    struct Entry
+    {
+        QString text;
+        FilePath helpFile;
+        quint64 characters = 0;
+    };
+
+    void rebuild(const Words &words)
+    {
+        m_entries.clear();
+        m_entries.reserve(words.size());
+        if constexpr (std::is_same_v<Words, QMap<QString, FilePath>>) {
+            for (auto it = words.cbegin(); it != words.cend(); ++it)
+                m_entries.push_back({it.key(), it.value(), characterMask(it.key())});
+        } else {
+            for (const QString &word : words)
+                m_entries.push_back({word, {}, characterMask(word)});
+        }
+        m_words = words;
+    }
+
+    QMutex m_mutex;
+    Words m_words;
+    std::vector<Entry> m_entries;
+};
+
+struct ProposalPools
+{
+    ProposalPool<QMap<QString, FilePath>> variables;
+    ProposalPool<QMap<QString, FilePath>> functions;
+    ProposalPool<QMap<QString, FilePath>> properties;
+    ProposalPool<QSet<QString>> generatorExpressions;
+    ProposalPool<QMap<QString, FilePath>> environmentVariables;
+    ProposalPool<QMap<QString, FilePath>> directoryProperties;
+    ProposalPool<QMap<QString, FilePath>> sourceProperties;
+    ProposalPool<QMap<QString, FilePath>> targetProperties;
+    ProposalPool<QMap<QString, FilePath>> testProperties;
+    ProposalPool<QMap<QString, FilePath>> includeStandardModules;
+    ProposalPool<QMap<QString, FilePath>> findModules;
+    ProposalPool<QMap<QString, FilePath>> policies;
+};
+
+static ProposalPools &proposalPools()
+{
+    static ProposalPools thePools;
+    return thePools;
+}
+
+// The words of a project, kept per build system so that switching between the files of
+// two projects does not rebuild them
+struct ProjectProposalPools
+{
+    ProposalPool<QMap<QString, FilePath>> variables;
+    ProposalPool<QMap<QString, FilePath>> functions;
+};
+
+// GUI thread only
+static std::shared_ptr<ProjectProposalPools> projectProposalPools(XMakeBuildSystem *buildSystem)
+{
+    static QHash<XMakeBuildSystem *, std::shared_ptr<ProjectProposalPools>> thePools;
+    if (!buildSystem)
+        return std::make_shared<ProjectProposalPools>();
+
+    std::shared_ptr<ProjectProposalPools> &pools = thePools[buildSystem];
+    if (!pools) {
+        pools = std::make_shared<ProjectProposalPools>();
+        QObject::connect(buildSystem, &QObject::destroyed, [buildSystem] {
+            thePools.remove(buildSystem);
+        });
+    }
+    return pools;
+}
+
 static QList<AssistProposalItemInterface *> generateList(
     const XMakeConfig &cache,
     const QIcon &icon,
+    const QString &prefix,
     const QList<AssistProposalItemInterface *> &existingList)
 {
     QHash<QString, AssistProposalItemInterface *> hash;
@@ -219,6 +368,8 @@ static QList<AssistProposalItemInterface *> generateList(
             continue;
 
         QString text = QString::fromUtf8(it->key);
+        if (!matchesPrefix(text, prefix))
+            continue;
         if (!hash.contains(text)) {
             MarkDownAssitProposalItem *item = new MarkDownAssitProposalItem();
             item->setText(text);
@@ -278,23 +429,14 @@ static int addFilePathItems(const AssistInterface *interface,
     return startPos;
 }
 
-static cmListFile parseXMakeListFromBuffer(const QByteArray &content)
-{
-    cmListFile xmakeListFile;
-    std::string errorString;
-    if (!content.isEmpty()) {
-        const std::string fileName = "buffer";
-        if (!xmakeListFile.ParseString(content.toStdString(), fileName, errorString))
-            return {};
-    }
-    return xmakeListFile;
-}
+using LocalFunctions = std::vector<XMakeFileAst::Function>;
 
-static QPair<QStringList, QStringList> getLocalFunctionsAndVariables(const cmListFile &xmakeListFile)
+static QPair<QStringList, QStringList> getLocalFunctionsAndVariables(
+    const LocalFunctions &localFunctions)
 {
     QStringList variables;
     QStringList functions;
-    for (const auto &func : xmakeListFile.Functions) {
+    for (const auto &[func, lineOffset] : localFunctions) {
         if (func.Arguments().size() == 0)
             continue;
 
@@ -306,8 +448,8 @@ static QPair<QStringList, QStringList> getLocalFunctionsAndVariables(const cmLis
     return {functions, variables};
 }
 
-static void updateXMakeConfigurationWithLocalData(XMakeConfig &xmakeCache,
-                                                  const cmListFile &xmakeListFile,
+static void updateXMakeConfigurationWithLocalData(IndexedXMakeConfig &xmakeCache,
+                                                  const LocalFunctions &localFunctions,
                                                   const FilePath &currentDir)
 {
     auto isValidXMakeVariable = [](const std::string &var) {
@@ -326,18 +468,18 @@ static void updateXMakeConfigurationWithLocalData(XMakeConfig &xmakeCache,
     };
 
     auto insertOrAppendListValue = [&xmakeCache](const QByteArray &key, const QByteArray &value) {
-        auto it = std::find_if(xmakeCache.begin(), xmakeCache.end(), [key](const auto &item) {
-            return item.key == key;
-        });
-        if (it == xmakeCache.end()) {
-            xmakeCache << XMakeConfigItem(key, value);
+        const XMakeConfigItem *item = xmakeCache.item(key);
+        if (!item) {
+            xmakeCache.insertOrReplace(XMakeConfigItem(key, value));
         } else {
-            it->value.append(";");
-            it->value.append(value);
+            XMakeConfigItem appended = *item;
+            appended.value.append(";");
+            appended.value.append(value);
+            xmakeCache.insertOrReplace(appended);
         }
     };
 
-    for (const auto &func : xmakeListFile.Functions) {
+    for (const auto &[func, lineOffset] : localFunctions) {
         const bool isSet = func.LowerCaseName() == "set" && func.Arguments().size() > 1;
         const bool isList = func.LowerCaseName() == "list" && func.Arguments().size() > 2;
         if (!isSet && !isList)
@@ -367,8 +509,131 @@ static void updateXMakeConfigurationWithLocalData(XMakeConfig &xmakeCache,
     }
 }
 
+// Caches the package directory listings for the find_package() completion. Local
+// directories are watched and dropped from the cache once they change, remote ones
+// are listed on every request. The number of watched directories is limited, the
+// oldest ones are dropped first.
+// One snapshot of the package files per prefix root like <prefix>/lib/xmake. Only the
+// roots are watched, installing or removing a package adds or removes a directory there.
+class PackageIndex : public QObject
+{
+public:
+    explicit PackageIndex(QObject *parent)
+        : QObject(parent)
+    {
+        connect(&m_watcher, &FileSystemWatcher::directoryChanged, this, [this](const QString &path) {
+            const FilePath root = FilePath::fromString(path);
+            QMutexLocker locker(&m_mutex);
+            const auto watched = m_watched.find(root);
+            if (watched != m_watched.end())
+                ++*watched;
+            m_packageFiles.remove(root);
+            m_subDirectoryPackageFiles.remove(root);
+        });
+    }
+
+    // Thread safe. The *.xmake files in the root.
+    QStringList packageFiles(const FilePath &root)
+    {
+        return cached(m_packageFiles, root, [root] { return xmakeFiles(root); });
+    }
+
+    // Thread safe. The *.xmake files in the subdirectories of the root.
+    QStringList subDirectoryPackageFiles(const FilePath &root)
+    {
+        return cached(m_subDirectoryPackageFiles, root, [root] {
+            QStringList result;
+            const FilePaths dirs = root.dirEntries({{"*"}, QDir::Dirs | QDir::NoDotAndDotDot});
+            for (const FilePath &dir : dirs)
+                result << xmakeFiles(dir);
+            return result;
+        });
+    }
+
+private:
+    static QStringList xmakeFiles(const FilePath &dir)
+    {
+        return Utils::transform<QStringList>(dir.dirEntries({{"*.xmake"}, QDir::Files}, QDir::Name),
+                                             &FilePath::fileName);
+    }
+
+    template<typename Scan>
+    QStringList cached(QHash<FilePath, QStringList> &cache, const FilePath &root, const Scan &scan)
+    {
+        std::optional<int> generation;
+        {
+            QMutexLocker locker(&m_mutex);
+            const auto watched = m_watched.constFind(root);
+            if (watched != m_watched.constEnd()) {
+                generation = *watched;
+                // Least recently used roots are dropped first
+                m_useOrder.removeOne(root);
+                m_useOrder.append(root);
+            }
+            const auto it = cache.constFind(root);
+            if (it != cache.constEnd())
+                return *it;
+        }
+
+        // Missing directories can not be watched, they are cheap to look up again
+        if (root.needsDevice() || !root.isDir())
+            return scan();
+
+        // A snapshot is only cached if the watch was in place before the scan started and
+        // nothing changed since, otherwise the change would never drop it. Roots seen for
+        // the first time get watched for the next request.
+        if (!generation) {
+            QMetaObject::invokeMethod(this, [this, root] { watch(root); }, Qt::QueuedConnection);
+            return scan();
+        }
+
+        const QStringList result = scan();
+        QMutexLocker locker(&m_mutex);
+        if (m_watched.value(root, -1) == *generation)
+            cache.insert(root, result);
+        return result;
+    }
+
+    // GUI thread only, the watcher belongs to it
+    void watch(const FilePath &root)
+    {
+        // Two roots for each prefix of all open configurations
+        const int maxWatchedRoots = 128;
+
+        if (m_watcher.watchesDirectory(root.path()))
+            return;
+        m_watcher.addDirectory(root.path(), FileSystemWatcher::WatchAllChanges);
+
+        QMutexLocker locker(&m_mutex);
+        m_watched.insert(root, 0);
+        m_useOrder.append(root);
+        while (m_useOrder.size() > maxWatchedRoots) {
+            const FilePath oldest = m_useOrder.takeFirst();
+            m_watcher.removeDirectory(oldest.path());
+            m_watched.remove(oldest);
+            m_packageFiles.remove(oldest);
+            m_subDirectoryPackageFiles.remove(oldest);
+        }
+    }
+
+    FileSystemWatcher m_watcher;
+    QMutex m_mutex;
+    // Counts the changes of each watched root
+    QHash<FilePath, int> m_watched;
+    QList<FilePath> m_useOrder;
+    QHash<FilePath, QStringList> m_packageFiles;
+    QHash<FilePath, QStringList> m_subDirectoryPackageFiles;
+};
+
+static PackageIndex *thePackageIndex = nullptr;
+
+void setupXMakeFileCompletion(QObject *guard)
+{
+    thePackageIndex = new PackageIndex(guard);
+}
+
 static QPair<QStringList, QStringList> getFindAndConfigXMakePackages(
-    const XMakeConfig &xmakeCache, const Environment &environment)
+    PackageIndex &packageIndex, const IndexedXMakeConfig &xmakeCache, const Environment &environment)
 {
     auto toFilePath = [](const QByteArray &str) -> FilePath {
         return FilePath::fromUserInput(QString::fromUtf8(str));
@@ -415,17 +680,11 @@ static QPair<QStringList, QStringList> getFindAndConfigXMakePackages(
                                              &FilePath::fromUserInput);
 
         for (const auto &prefix : paths) {
-            // Only search for directories if we have a prefix
-            const FilePaths dirs = !m.pathPrefix.isEmpty()
-                                       ? prefix.pathAppended(m.pathPrefix)
-                                             .dirEntries({{"*"}, QDir::Dirs | QDir::NoDotAndDotDot})
-                                       : FilePaths{prefix};
+            // Only search in subdirectories if we have a prefix
             const QStringList xmakeFiles
-                = Utils::transform<QStringList>(dirs, [](const FilePath &path) {
-                      return Utils::transform(path.dirEntries({{"*.xmake"}, QDir::Files},
-                                                              QDir::Name),
-                                              &FilePath::fileName);
-                  });
+                = !m.pathPrefix.isEmpty()
+                      ? packageIndex.subDirectoryPackageFiles(prefix.pathAppended(m.pathPrefix))
+                      : packageIndex.packageFiles(prefix);
             m.result << Utils::transform(xmakeFiles, m.function);
         }
         m.result = Utils::filtered(m.result, std::not_fn(&QString::isEmpty));
@@ -443,13 +702,17 @@ public:
     QStringList buildTargets;
     QStringList importedTargets;
     QStringList findPackageVariables;
-    XMakeConfig xmakeConfiguration;
+    IndexedXMakeConfig xmakeConfiguration;
     Environment environment = Environment::systemEnvironment();
+    LocalFunctions localFunctions;
+    PackageIndex *packageIndex = nullptr;
+    std::shared_ptr<ProjectProposalPools> projectPools;
 };
 
 PerformInputDataPtr XMakeFileCompletionAssist::generatePerformInputData() const
 {
     PerformInputDataPtr data = PerformInputDataPtr(new PerformInputData);
+    data->packageIndex = thePackageIndex;
 
     const FilePath &filePath = interface()->filePath();
     if (!filePath.isEmpty() && filePath.isFile()) {
@@ -457,7 +720,9 @@ PerformInputDataPtr XMakeFileCompletionAssist::generatePerformInputData() const
             data->keywords = tool->keywords();
     }
 
-    if (auto bs = qobject_cast<XMakeBuildSystem *>(ProjectTree::currentBuildSystem())) {
+    auto bs = qobject_cast<XMakeBuildSystem *>(ProjectTree::currentBuildSystem());
+    data->projectPools = projectProposalPools(bs);
+    if (bs) {
         for (const auto &target : std::as_const(bs->buildTargets()))
             if (target.targetType != TargetType::UtilityType)
                 data->buildTargets << target.title;
@@ -470,14 +735,19 @@ PerformInputDataPtr XMakeFileCompletionAssist::generatePerformInputData() const
         data->environment = bs->xmakeBuildConfiguration()->configureEnvironment();
     }
 
+    // Needs the editor's document, which is gone after prepareForAsyncUse()
+    if (QTextDocument *document = interface()->textDocument())
+        data->localFunctions = XMakeFileAst::forDocument(document)->functions();
+
     return data;
 }
 
 IAssistProposal *XMakeFileCompletionAssist::perform()
 {
     IAssistProposal *result = immediateProposal();
+    PerformInputDataPtr inputData = generatePerformInputData();
     interface()->prepareForAsyncUse();
-    m_watcher.setFuture(Utils::asyncRun([this, inputData = generatePerformInputData()] {
+    m_watcher.setFuture(Utils::asyncRun([this, inputData] {
         interface()->recreateTextDocument();
         return doPerform(inputData);
     }));
@@ -508,39 +778,55 @@ IAssistProposal *XMakeFileCompletionAssist::doPerform(const PerformInputDataPtr
         }
     }
 
-    cmListFile xmakeListFile = parseXMakeListFromBuffer(
-        interface()->textAt(0, prevFunctionEnd + 1).toUtf8());
-    auto [localFunctions, localVariables] = getLocalFunctionsAndVariables(xmakeListFile);
+    // Only the functions up to the end of the previous function are in scope
+    const long prevFunctionEndLine
+        = interface()->textDocument()->findBlock(prevFunctionEnd).blockNumber() + 1;
+    const LocalFunctions xmakeListFunctions
+        = Utils::filtered(data->localFunctions, [prevFunctionEndLine](const auto &function) {
+              return function.lineEnd() <= prevFunctionEndLine;
+          });
+    auto [localFunctions, localVariables] = getLocalFunctionsAndVariables(xmakeListFunctions);
 
-    XMakeConfig xmakeConfiguration = data->xmakeConfiguration;
+    IndexedXMakeConfig xmakeConfiguration = data->xmakeConfiguration;
     const FilePath currentDir = interface()->filePath().absolutePath();
-    updateXMakeConfigurationWithLocalData(xmakeConfiguration, xmakeListFile, currentDir);
+    updateXMakeConfigurationWithLocalData(xmakeConfiguration, xmakeListFunctions, currentDir);
 
-    auto [findModules, configModules] = getFindAndConfigXMakePackages(xmakeConfiguration,
+    auto [findModules, configModules] = getFindAndConfigXMakePackages(*data->packageIndex,
+                                                                      xmakeConfiguration,
                                                                       data->environment);
 
+    const QString prefix = interface()->textAt(startPos, interface()->position() - startPos);
+    ProposalPools &pools = proposalPools();
     QList<AssistProposalItemInterface *> items;
 
     const QString varGenexToken = interface()->textAt(startPos - 2, 2);
     const QString varEnvironmentToken = interface()->textAt(startPos - 5, 5);
     if (varGenexToken == "${" || varGenexToken == "$<" || varEnvironmentToken == "$ENV{") {
         if (varGenexToken == "${") {
-            items.append(generateList(data->keywords.variables, m_variableIcon));
-            items.append(generateList(data->projectVariables, m_projectVariableIcon));
-            items.append(generateList(data->findPackageVariables, m_projectVariableIcon));
+            items.append(pools.variables.items(data->keywords.variables, m_variableIcon, prefix));
+            items.append(data->projectPools->variables.items(data->projectVariables,
+                                                             m_projectVariableIcon,
+                                                             prefix));
+            items.append(generateList(data->findPackageVariables, m_projectVariableIcon, prefix));
         }
         if (varGenexToken == "$<")
-            items.append(generateList(data->keywords.generatorExpressions, m_genexIcon));
+            items.append(pools.generatorExpressions.items(data->keywords.generatorExpressions,
+                                                          m_genexIcon,
+                                                          prefix));
 
         if (varEnvironmentToken == "$ENV{")
-            items.append(generateList(data->keywords.environmentVariables, m_variableIcon));
+            items.append(pools.environmentVariables.items(data->keywords.environmentVariables,
+                                                          m_variableIcon,
+                                                          prefix));
 
         return new GenericProposal(startPos, items);
     }
 
     const QString ifEnvironmentToken = interface()->textAt(startPos - 4, 4);
     if ((functionName == "if" || functionName == "elseif") && ifEnvironmentToken == "ENV{")
-        items.append(generateList(data->keywords.environmentVariables, m_variableIcon));
+        items.append(pools.environmentVariables.items(data->keywords.environmentVariables,
+                                                      m_variableIcon,
+                                                      prefix));
 
     int fileStartPos = startPos;
     const auto onlyFileItems = [&] { return fileStartPos != startPos; };
@@ -548,15 +834,17 @@ IAssistProposal *XMakeFileCompletionAssist::doPerform(const PerformInputDataPtr
     if (functionName == "if" || functionName == "elseif" || functionName == "while"
         || functionName == "set" || functionName == "list"
         || functionName == "xmake_print_variables") {
-        items.append(generateList(data->keywords.variables, m_variableIcon));
-        items.append(generateList(data->projectVariables, m_projectVariableIcon));
-        items.append(generateList(data->findPackageVariables, m_projectVariableIcon));
-        items.append(generateList(localVariables, m_variableIcon));
-        items.append(generateList(xmakeConfiguration, m_variableIcon, items));
+        items.append(pools.variables.items(data->keywords.variables, m_variableIcon, prefix));
+        items.append(data->projectPools->variables.items(data->projectVariables,
+                                                         m_projectVariableIcon,
+                                                         prefix));
+        items.append(generateList(data->findPackageVariables, m_projectVariableIcon, prefix));
+        items.append(generateList(localVariables, m_variableIcon, prefix));
+        items.append(generateList(xmakeConfiguration, m_variableIcon, prefix, items));
     }
 
     if (functionName == "if" || functionName == "elseif" || functionName == "xmake_policy")
-        items.append(generateList(data->keywords.policies, m_variableIcon));
+        items.append(pools.policies.items(data->keywords.policies, m_variableIcon, prefix));
 
     if (functionName.contains("path") || functionName.contains("file")
         || functionName.contains("add_executable") || functionName.contains("add_library")
@@ -567,23 +855,33 @@ IAssistProposal *XMakeFileCompletionAssist::doPerform(const PerformInputDataPtr
     }
 
     if (functionName == "set_property" || functionName == "xmake_print_properties")
-        items.append(generateList(data->keywords.properties, m_propertyIcon));
+        items.append(pools.properties.items(data->keywords.properties, m_propertyIcon, prefix));
 
     if (functionName == "set_directory_properties")
-        items.append(generateList(data->keywords.directoryProperties, m_propertyIcon));
+        items.append(pools.directoryProperties.items(data->keywords.directoryProperties,
+                                                     m_propertyIcon,
+                                                     prefix));
     if (functionName == "set_source_files_properties")
-        items.append(generateList(data->keywords.sourceProperties, m_propertyIcon));
+        items.append(pools.sourceProperties.items(data->keywords.sourceProperties,
+                                                  m_propertyIcon,
+                                                  prefix));
     if (functionName == "set_target_properties")
-        items.append(generateList(data->keywords.targetProperties, m_propertyIcon));
+        items.append(pools.targetProperties.items(data->keywords.targetProperties,
+                                                  m_propertyIcon,
+                                                  prefix));
     if (functionName == "set_tests_properties")
-        items.append(generateList(data->keywords.testProperties, m_propertyIcon));
+        items.append(pools.testProperties.items(data->keywords.testProperties,
+                                                m_propertyIcon,
+                                                prefix));
 
     if (functionName == "include" && !onlyFileItems())
-        items.append(generateList(data->keywords.includeStandardModules, m_moduleIcon));
+        items.append(pools.includeStandardModules.items(data->keywords.includeStandardModules,
+                                                        m_moduleIcon,
+                                                        prefix));
     if (functionName == "find_package") {
-        items.append(generateList(data->keywords.findModules, m_moduleIcon));
-        items.append(generateList(findModules, m_moduleIcon));
-        items.append(generateList(configModules, m_moduleIcon));
+        items.append(pools.findModules.items(data->keywords.findModules, m_moduleIcon, prefix));
+        items.append(generateList(findModules, m_moduleIcon, prefix));
+        items.append(generateList(configModules, m_moduleIcon, prefix));
     }
 
     if ((functionName.contains("target") || functionName == "install"
@@ -591,18 +889,20 @@ IAssistProposal *XMakeFileCompletionAssist::doPerform(const PerformInputDataPtr
          || functionName == "export" || functionName == "xmake_print_properties"
          || functionName == "if" || functionName == "elseif")
         && !onlyFileItems()) {
-        items.append(generateList(data->buildTargets, m_targetsIcon));
-        items.append(generateList(data->importedTargets, m_importedTargetIcon));
+        items.append(generateList(data->buildTargets, m_targetsIcon, prefix));
+        items.append(generateList(data->importedTargets, m_importedTargetIcon, prefix));
     }
 
     if (data->keywords.functionArgs.contains(functionName) && !onlyFileItems()) {
         const QStringList functionSymbols = data->keywords.functionArgs.value(functionName);
-        items.append(generateList(functionSymbols, m_argsIcon));
+        items.append(generateList(functionSymbols, m_argsIcon, prefix));
     } else if (functionName.isEmpty()) {
         // On a new line we just want functions
-        items.append(generateList(data->keywords.functions, m_functionIcon));
-        items.append(generateList(data->projectFunctions, m_projectFunctionIcon));
-        items.append(generateList(localFunctions, m_functionIcon));
+        items.append(pools.functions.items(data->keywords.functions, m_functionIcon, prefix));
+        items.append(data->projectPools->functions.items(data->projectFunctions,
+                                                         m_projectFunctionIcon,
+                                                         prefix));
+        items.append(generateList(localFunctions, m_functionIcon, prefix));
 
         // Snippets would make more sense only for the top level suggestions
         items.append(m_snippetCollector.collect());
@@ -610,15 +910,17 @@ IAssistProposal *XMakeFileCompletionAssist::doPerform(const PerformInputDataPtr
         // Inside an unknown function we could have variables or properties
         fileStartPos = addFilePathItems(interface(), items, startPos);
         if (!onlyFileItems()) {
-            items.append(generateList(data->keywords.variables, m_variableIcon));
-            items.append(generateList(data->projectVariables, m_projectVariableIcon));
-            items.append(generateList(localVariables, m_variableIcon));
-            items.append(generateList(xmakeConfiguration, m_variableIcon, items));
-            items.append(generateList(data->findPackageVariables, m_projectVariableIcon));
-
-            items.append(generateList(data->keywords.properties, m_propertyIcon));
-            items.append(generateList(data->buildTargets, m_targetsIcon));
-            items.append(generateList(data->importedTargets, m_importedTargetIcon));
+            items.append(pools.variables.items(data->keywords.variables, m_variableIcon, prefix));
+            items.append(data->projectPools->variables.items(data->projectVariables,
+                                                             m_projectVariableIcon,
+                                                             prefix));
+            items.append(generateList(localVariables, m_variableIcon, prefix));
+            items.append(generateList(xmakeConfiguration, m_variableIcon, prefix, items));
+            items.append(generateList(data->findPackageVariables, m_projectVariableIcon, prefix));
+
+            items.append(pools.properties.items(data->keywords.properties, m_propertyIcon, prefix));
+            items.append(generateList(data->buildTargets, m_targetsIcon, prefix));
+            items.append(generateList(data->importedTargets, m_importedTargetIcon, prefix));
         }
     }
 
@@ -13,4 +13,6 @@ public:
         int activationCharSequenceLength() const final;
         bool isActivationCharSequence(const QString &sequence) const final;
     };
+
+    void setupXMakeFileCompletion(QObject *guard);
 } // XMakeProjectManager::Internal
@@ -4,6 +4,7 @@
 
 #include "xmakeformatter.h"
 
+#include "xmakenativeformatter.h"
 #include "xmakeprojectconstants.h"
 #include "xmakeprojectmanagertr.h"
 
@@ -12,6 +13,7 @@
 #include <coreplugin/actionmanager/command.h>
 #include <coreplugin/coreconstants.h>
 #include <coreplugin/dialogs/ioptionspage.h>
+#include <coreplugin/documentmanager.h>
 #include <coreplugin/editormanager/editormanager.h>
 #include <coreplugin/editormanager/ieditor.h>
 #include <coreplugin/idocument.h>
@@ -26,11 +28,16 @@
 #include <texteditor/texteditor.h>
 
 #include <utils/algorithm.h>
+#include <utils/filesystemwatcher.h>
 #include <utils/genericconstants.h>
 #include <utils/layoutbuilder.h>
 #include <utils/mimeconstants.h>
 #include <utils/mimeutils.h>
+#include <utils/qtcassert.h>
 
+#include <QDeadlineTimer>
+#include <QJsonDocument>
+#include <QJsonObject>
 #include <QMenu>
 
 using namespace Core;
@@ -38,6 +45,79 @@ using namespace TextEditor;
 using namespace Utils;
 
 namespace XMakeProjectManager::Internal {
+    static const QStringList &formatConfigFileNames() {
+        static const QStringList fileNames { ".xmake-format",
+                                             ".xmake-format.py",
+                                             ".xmake-format.json",
+                                             ".xmake-format.yaml",
+                                             "xmake-format.py",
+                                             "xmake-format.json",
+                                             "xmake-format.yaml" };
+        return fileNames;
+    }
+
+    // The config files found for the directories of formatted files. The found files are
+    // watched and saving a config file drops all entries. Entries also expire, to notice
+    // config files created outside of the editor.
+    class FormatConfigCache : public QObject {
+public:
+        explicit FormatConfigCache(QObject *parent)
+            : QObject(parent) {
+            connect(&m_watcher, &FileSystemWatcher::fileChanged, this, &FormatConfigCache::clear);
+            connect(DocumentManager::instance(), &DocumentManager::filesChangedInternally,
+                    this, [this](const FilePaths &files) {
+                        if (anyOf(files, [](const FilePath &file) {
+                                      return formatConfigFileNames().contains(file.fileName());
+                                  })) {
+                            clear();
+                        }
+                    });
+        }
+
+        std::optional<FilePaths> configFiles(const FilePath &directory) const {
+            const auto it = m_entries.constFind(directory);
+            if (it == m_entries.constEnd() || it->expiry.hasExpired()) {
+                return {};
+            }
+            return it->configFiles;
+        }
+
+        void insert(const FilePath &directory, const FilePaths &configFiles) {
+            for (auto it = m_entries.begin(); it != m_entries.end();) {
+                if (it->expiry.hasExpired()) {
+                    it = m_entries.erase(it);
+                } else {
+                    ++it;
+                }
+            }
+            m_entries.insert(directory, {configFiles, QDeadlineTimer(std::chrono::seconds(30))});
+
+            for (const FilePath &configFile : configFiles) {
+                if (!configFile.needsDevice() && !m_watcher.watchesFile(configFile.path())) {
+                    m_watcher.addFile(configFile.path(), FileSystemWatcher::WatchAllChanges);
+                }
+            }
+        }
+
+private:
+        void clear() {
+            m_entries.clear();
+            const QStringList files = m_watcher.files();
+            if (!files.isEmpty()) {
+                m_watcher.removeFiles(files);
+            }
+        }
+
+        struct Entry {
+            FilePaths configFiles;
+            QDeadlineTimer expiry;
+        };
+        QHash<FilePath, Entry> m_entries;
+        FileSystemWatcher m_watcher;
+    };
+
+    static FormatConfigCache *theFormatConfigCache = nullptr;
+
     class XMakeFormatterSettings : public AspectContainer {
 public:
         XMakeFormatterSettings() {
@@ -62,6 +142,35 @@ public:
             autoFormatMime.setLabelText(Tr::tr("Restrict to MIME types:"));
             autoFormatMime.setDisplayStyle(StringAspect::LineEditDisplay);
 
+            useNativeFormatter.setSettingsKey("useNativeFormatter");
+            useNativeFormatter.setLabelText(Tr::tr("Use the built-in formatter"));
+            useNativeFormatter.setToolTip(
+                Tr::tr("Formats without running the command. Only the indentation, the case of "
+                       "the command names and the empty lines are changed. The tab_size, "
+                       "use_tabchars and command_case values of a JSON configuration file "
+                       "take precedence."));
+
+            nativeIndentWidth.setSettingsKey("nativeIndentWidth");
+            nativeIndentWidth.setDefaultValue(2);
+            nativeIndentWidth.setRange(1, 16);
+            nativeIndentWidth.setLabelText(Tr::tr("Indentation width:"));
+
+            nativeUseTabs.setSettingsKey("nativeUseTabs");
+            nativeUseTabs.setLabelText(Tr::tr("Indent with tabs"));
+            nativeUseTabs.setLabelPlacement(BoolAspect::LabelPlacement::AtCheckBox);
+
+            nativeCommandCase.setSettingsKey("nativeCommandCase");
+            nativeCommandCase.setDisplayStyle(SelectionAspect::DisplayStyle::ComboBox);
+            nativeCommandCase.addOption(Tr::tr("Unchanged"));
+            nativeCommandCase.addOption(Tr::tr("Lower case"));
+            nativeCommandCase.addOption(Tr::tr("Upper case"));
+            nativeCommandCase.setLabelText(Tr::tr("Command names:"));
+
+            nativeMaxEmptyLines.setSettingsKey("nativeMaxEmptyLines");
+            nativeMaxEmptyLines.setDefaultValue(1);
+            nativeMaxEmptyLines.setRange(0, 10);
+            nativeMaxEmptyLines.setLabelText(Tr::tr("Maximum consecutive empty lines:"));
+
             setLayouter([this] {
                             using namespace Layouting;
 
@@ -74,6 +183,16 @@ public:
                             return Column {
                                 Row { xmakeFormatter, command },
                                 Space(10),
+                                Group {
+                                    title(Tr::tr("Built-in Formatter")),
+                                    useNativeFormatter.groupChecker(),
+                                    Form {
+                                        nativeIndentWidth, br,
+                                        nativeUseTabs, br,
+                                        nativeCommandCase, br,
+                                        nativeMaxEmptyLines, br
+                                    }
+                                },
                                 Group {
                                     title(Tr::tr("Automatic Formatting on File Save")),
                                     autoFormatOnSave.groupChecker(),
@@ -97,6 +216,13 @@ public:
 
             Core::Command *cmd = ActionManager::registerAction(&formatFile, Constants::XMAKEFORMATTER_ACTION_ID);
             connect(&formatFile, &QAction::triggered, this, [this] {
+                        if (useNativeFormatter()) {
+                            if (auto widget = TextEditorWidget::currentTextEditorWidget()) {
+                                formatNatively(widget);
+                            }
+                            return;
+                        }
+
                         auto command = formatCommand();
                         if (auto editor = EditorManager::currentEditor()) {
                             extendCommandWithConfigs(command, editor->document()->filePath());
@@ -110,12 +236,13 @@ public:
             auto updateActions = [this] {
                 auto editor = EditorManager::currentEditor();
 
-                formatFile.setEnabled(haveValidFormatCommand && editor
-                                      && isApplicable(editor->document()));
+                formatFile.setEnabled(canFormat() && editor && isApplicable(editor->document()));
             };
 
             connect(&autoFormatMime, &Utils::StringAspect::changed,
                     this, updateActions);
+            connect(&useNativeFormatter, &Utils::BoolAspect::changed,
+                    this, updateActions);
             connect(EditorManager::instance(), &EditorManager::currentEditorChanged,
                     this, updateActions);
             connect(EditorManager::instance(), &EditorManager::aboutToSave,
@@ -126,15 +253,22 @@ public:
             const FilePath commandPath = command().searchInPath();
             haveValidFormatCommand = commandPath.exists() && commandPath.isExecutableFile();
 
-            formatFile.setEnabled(haveValidFormatCommand);
+            formatFile.setEnabled(canFormat());
             connect(&command, &FilePathAspect::validChanged, this, [this](bool validState) {
                         haveValidFormatCommand = validState;
-                        formatFile.setEnabled(haveValidFormatCommand);
+                        formatFile.setEnabled(canFormat());
                     });
         }
 
+        bool canFormat() const {
+            return haveValidFormatCommand || useNativeFormatter();
+        }
+
         bool isApplicable(const IDocument *document) const;
 
+        NativeFormatOptions nativeFormatOptions(const FilePath &source) const;
+        void formatNatively(TextEditorWidget *widget) const;
+
         void applyIfNecessary(IDocument *document) const;
 
         TextEditor::Command formatCommand() const {
@@ -151,13 +285,7 @@ public:
                 return FilePaths();
             }
 
-            return filtered(transform({ ".xmake-format",
-                                        ".xmake-format.py",
-                                        ".xmake-format.json",
-                                        ".xmake-format.yaml",
-                                        "xmake-format.py",
-                                        "xmake-format.json",
-                                        "xmake-format.yaml" },
+            return filtered(transform(formatConfigFileNames(),
                                       [dir](const QString &fileName) {
                                           return dir.pathAppended(fileName);
                                       }),
@@ -165,16 +293,23 @@ public:
         }
 
         static FilePaths findConfigs(const FilePath &fileName) {
-            FilePath parentDirectory = fileName.parentDir();
-            while (parentDirectory.exists()) {
-                FilePaths configFiles = formatConfigFiles(parentDirectory);
+            // Formatting on save looks up the same directories over and over again
+            QTC_ASSERT(theFormatConfigCache, return {});
+            const FilePath directory = fileName.parentDir();
+            if (const std::optional<FilePaths> cached = theFormatConfigCache->configFiles(directory)) {
+                return *cached;
+            }
+
+            FilePaths configFiles;
+            for (FilePath parentDirectory = directory; parentDirectory.exists();
+                 parentDirectory = parentDirectory.parentDir()) {
+                configFiles = formatConfigFiles(parentDirectory);
                 if (!configFiles.isEmpty()) {
-                    return configFiles;
+                    break;
                 }
-
-                parentDirectory = parentDirectory.parentDir();
             }
-            return FilePaths();
+            theFormatConfigCache->insert(directory, configFiles);
+            return configFiles;
         }
 
         static void extendCommandWithConfigs(TextEditor::Command &command, const FilePath &source) {
@@ -190,6 +325,11 @@ public:
         BoolAspect autoFormatOnSave { this };
         BoolAspect autoFormatOnlyCurrentProject { this };
         StringAspect autoFormatMime { this };
+        BoolAspect useNativeFormatter { this };
+        IntegerAspect nativeIndentWidth { this };
+        BoolAspect nativeUseTabs { this };
+        SelectionAspect nativeCommandCase { this };
+        IntegerAspect nativeMaxEmptyLines { this };
 
         QAction formatFile { Tr::tr("Format &Current File") };
     };
@@ -211,6 +351,47 @@ public:
                      });
     }
 
+    NativeFormatOptions XMakeFormatterSettings::nativeFormatOptions(const FilePath &source) const {
+        NativeFormatOptions options;
+        options.indentWidth = nativeIndentWidth();
+        options.useTabs = nativeUseTabs();
+        options.commandCase = NativeFormatOptions::CommandCase(nativeCommandCase());
+        options.maxEmptyLines = nativeMaxEmptyLines();
+
+        // The values of a JSON configuration take precedence, other formats are ignored
+        for (const FilePath &configFile : findConfigs(source)) {
+            const expected_str<QByteArray> contents = configFile.fileContents();
+            if (!contents) {
+                continue;
+            }
+            QJsonObject config = QJsonDocument::fromJson(*contents).object();
+            if (config.value("format").isObject()) {
+                config = config.value("format").toObject();
+            }
+
+            options.indentWidth = config.value("tab_size").toInt(options.indentWidth);
+            options.useTabs = config.value("use_tabchars").toBool(options.useTabs);
+            const QString commandCase = config.value("command_case").toString();
+            if (commandCase == "lower") {
+                options.commandCase = NativeFormatOptions::Lower;
+            } else if (commandCase == "upper") {
+                options.commandCase = NativeFormatOptions::Upper;
+            } else if (commandCase == "unchanged") {
+                options.commandCase = NativeFormatOptions::Unchanged;
+            }
+        }
+        return options;
+    }
+
+    void XMakeFormatterSettings::formatNatively(TextEditorWidget *widget) const {
+        const QString text = widget->toPlainText();
+        const std::optional<QString> formatted
+            = formatXMakeText(text, nativeFormatOptions(widget->textDocument()->filePath()));
+        if (formatted && *formatted != text) {
+            TextEditor::updateEditorText(widget, *formatted);
+        }
+    }
+
     void XMakeFormatterSettings::applyIfNecessary(IDocument *document) const {
         if (!autoFormatOnSave()) {
             return;
@@ -236,7 +417,7 @@ public:
         }
 
         TextEditor::Command command = formatCommand();
-        if (!command.isValid()) {
+        if (!useNativeFormatter() && !command.isValid()) {
             return;
         }
 
@@ -248,6 +429,10 @@ public:
         IEditor *currentEditor = EditorManager::currentEditor();
         IEditor *editor = editors.contains(currentEditor) ? currentEditor : editors.first();
         if (auto widget = TextEditorWidget::fromEditor(editor)) {
+            if (useNativeFormatter()) {
+                formatNatively(widget);
+                return;
+            }
             extendCommandWithConfigs(command, editor->document()->filePath());
             TextEditor::formatEditor(widget, command);
         }
@@ -271,9 +456,11 @@ public:
         }
     };
 
-    void setupXMakeFormatter() {
+    void setupXMakeFormatter(QObject *guard) {
         static const XMakeFormatterSettingsPage theXMakeFormatterSettingsPage;
 
+        theFormatConfigCache = new FormatConfigCache(guard);
+
         formatterSettings();
     };
 } // XMakeProjectManager::Internal
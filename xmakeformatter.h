@@ -4,8 +4,14 @@
 
 #pragma once
 
+#include <QtGlobal>
+
+QT_BEGIN_NAMESPACE
+class QObject;
+QT_END_NAMESPACE
+
 namespace XMakeProjectManager::Internal {
 
-void setupXMakeFormatter();
+void setupXMakeFormatter(QObject *guard);
 
 } // XMakeProjectManager::Internal
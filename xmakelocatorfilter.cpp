@@ -16,6 +16,12 @@
 #include <projectexplorer/target.h>
 
 #include <utils/algorithm.h>
+#include <utils/async.h>
+
+#include <QRegularExpression>
+
+#include <array>
+#include <numeric>
 
 using namespace Core;
 using namespace ProjectExplorer;
@@ -27,17 +33,77 @@ using BuildAcceptor = std::function<void(const FilePath &, const QString &)>;
 
 // XMakeBuildTargetFilter
 
+struct ProjectTargets
+{
+    FilePath projectPath;
+    XMakeBuildSystem::TargetIndex targets;
+};
+
+static void matchTargets(QPromise<void> &promise, const LocatorStorage &storage,
+                         const QList<ProjectTargets> &projects, const BuildAcceptor &acceptor)
+{
+    const QString input = storage.input();
+    const QRegularExpression regExp = ILocatorFilter::createRegExp(input);
+    if (!regExp.isValid())
+        return;
+
+    // Exact matches first, then prefix matches, then the rest
+    std::array<LocatorFilterEntries, int(ILocatorFilter::MatchLevel::Count)> entries;
+    for (const ProjectTargets &project : projects) {
+        for (const XMakeBuildSystem::TargetIndexEntry &target : *project.targets) {
+            if (promise.isCanceled())
+                return;
+            // Utility targets can only be built, there is nothing to open
+            const bool realTarget = !target.definition.targetFilePath.isEmpty();
+            if (!acceptor && !realTarget)
+                continue;
+            const QRegularExpressionMatch match = regExp.match(target.title);
+            if (!match.hasMatch())
+                continue;
+
+            const FilePath projectPath = project.projectPath;
+            const QString displayName = target.title;
+            LocatorFilterEntry entry;
+            entry.displayName = displayName;
+            if (acceptor) {
+                entry.acceptor = [projectPath, displayName, acceptor] {
+                    acceptor(projectPath, displayName);
+                    return AcceptResult();
+                };
+            }
+            if (realTarget) {
+                entry.linkForEditor = target.definition;
+                entry.extraInfo = target.definition.targetFilePath.shortNativePath();
+            } else {
+                entry.extraInfo = projectPath.shortNativePath();
+            }
+            entry.highlightInfo = ILocatorFilter::highlightInfo(match);
+            entry.filePath = projectPath;
+
+            ILocatorFilter::MatchLevel level = ILocatorFilter::MatchLevel::Normal;
+            if (target.title.compare(input, Qt::CaseInsensitive) == 0)
+                level = ILocatorFilter::MatchLevel::Best;
+            else if (target.title.startsWith(input, Qt::CaseInsensitive))
+                level = ILocatorFilter::MatchLevel::Better;
+            else if (match.capturedStart() == 0)
+                level = ILocatorFilter::MatchLevel::Good;
+            entries[int(level)].append(entry);
+        }
+    }
+    storage.reportOutput(std::accumulate(std::begin(entries), std::end(entries),
+                                         LocatorFilterEntries()));
+}
+
 static LocatorMatcherTasks xmakeMatchers(const BuildAcceptor &acceptor)
 {
     using namespace Tasking;
 
     Storage<LocatorStorage> storage;
 
-    const auto onSetup = [storage, acceptor] {
-        const QString input = storage->input();
-        const QList<Project *> projects = ProjectManager::projects();
-        LocatorFilterEntries entries;
-        for (Project *project : projects) {
+    const auto onSetup = [storage, acceptor](Async<void> &async) {
+        // Only the shared target indexes are collected in the GUI thread
+        QList<ProjectTargets> projects;
+        for (Project *project : ProjectManager::projects()) {
             const auto xmakeProject = qobject_cast<const XMakeProject *>(project);
             if (!xmakeProject || !xmakeProject->activeTarget())
                 continue;
@@ -45,43 +111,12 @@ static LocatorMatcherTasks xmakeMatchers(const BuildAcceptor &acceptor)
                 xmakeProject->activeTarget()->buildSystem());
             if (!bs)
                 continue;
-
-            const QList<XMakeBuildTarget> buildTargets = bs->buildTargets();
-            for (const XMakeBuildTarget &target : buildTargets) {
-                if (XMakeBuildSystem::filteredOutTarget(target))
-                    continue;
-                const int index = target.title.indexOf(input, 0, Qt::CaseInsensitive);
-                if (index >= 0) {
-                    const FilePath projectPath = xmakeProject->projectFilePath();
-                    const QString displayName = target.title;
-                    LocatorFilterEntry entry;
-                    entry.displayName = displayName;
-                    if (acceptor) {
-                        entry.acceptor = [projectPath, displayName, acceptor] {
-                            acceptor(projectPath, displayName);
-                            return AcceptResult();
-                        };
-                    }
-                    bool realTarget = false;
-                    if (!target.backtrace.isEmpty() && target.targetType != UtilityType) {
-                        const FilePath path = target.backtrace.last().path;
-                        const int line = target.backtrace.last().line;
-                        entry.linkForEditor = {path, line};
-                        entry.extraInfo = path.shortNativePath();
-                        realTarget = true;
-                    } else {
-                        entry.extraInfo = projectPath.shortNativePath();
-                    }
-                    entry.highlightInfo = {index, int(input.length())};
-                    entry.filePath = xmakeProject->projectFilePath();
-                    if (acceptor || realTarget)
-                        entries.append(entry);
-                }
-            }
+            if (XMakeBuildSystem::TargetIndex targets = bs->targetIndex())
+                projects.append({xmakeProject->projectFilePath(), targets});
         }
-        storage->reportOutput(entries);
+        async.setConcurrentCallData(matchTargets, *storage, projects, acceptor);
     };
-    return {{Sync(onSetup), storage}};
+    return {{AsyncTask<void>(onSetup), storage}};
 }
 
 static void setupFilter(ILocatorFilter *filter)
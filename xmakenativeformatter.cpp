@@ -0,0 +1,267 @@
+// Copyright (C) 2016 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only WITH Qt-GPL-exception-1.0
+
+#include "xmakenativeformatter.h"
+
+#include "3rdparty/xmake/cmListFileLexer.h"
+
+#include <QByteArrayList>
+#include <QScopeGuard>
+#include <QSet>
+
+#include <cctype>
+#include <vector>
+
+namespace XMakeProjectManager::Internal {
+
+namespace {
+
+struct LineInfo
+{
+    // Nesting at the start of the line
+    int blockDepth = 0;
+    int parenDepth = 0;
+    // The first token closes a block or a parenthesis
+    bool dedent = false;
+    bool hasToken = false;
+    // The line is part of a multi-line argument or bracket comment
+    bool startsInToken = false;
+    bool endsInToken = false;
+};
+
+struct CaseEdit
+{
+    long line = 0;
+    long column = 0;
+    int length = 0;
+};
+
+} // namespace
+
+std::optional<QString> formatXMakeText(const QString &text, const NativeFormatOptions &options)
+{
+    static const QSet<QByteArray> blockOpeners{"if", "foreach", "while", "function", "macro", "block"};
+    static const QSet<QByteArray> blockClosers{"endif", "endforeach", "endwhile", "endfunction",
+                                               "endmacro", "endblock"};
+    static const QSet<QByteArray> blockMiddles{"else", "elseif"};
+
+    const QByteArray input = text.toUtf8();
+    QByteArrayList lines = input.split('\n');
+    const bool endsWithNewline = input.endsWith('\n');
+    if (endsWithNewline)
+        lines.removeLast();
+
+    // One more for the state after the last newline
+    std::vector<LineInfo> info(lines.size() + 1);
+    std::vector<CaseEdit> caseEdits;
+
+    cmListFileLexer *lexer = cmListFileLexer_New();
+    const QScopeGuard cleanup([lexer] { cmListFileLexer_Delete(lexer); });
+    if (!cmListFileLexer_SetString(lexer, input.constData(), int(input.size())))
+        return {};
+
+    int blockDepth = 0;
+    int parenDepth = 0;
+    int pendingBlockDelta = 0;
+    bool expectCommand = true;
+    while (cmListFileLexer_Token *token = cmListFileLexer_Scan(lexer)) {
+        if (token->line < 1 || token->line > lines.size())
+            return {};
+        LineInfo &line = info[token->line - 1];
+
+        switch (token->type) {
+        case cmListFileLexer_Token_BadCharacter:
+        case cmListFileLexer_Token_BadBracket:
+        case cmListFileLexer_Token_BadString:
+            return {};
+        case cmListFileLexer_Token_None:
+        case cmListFileLexer_Token_Space:
+            continue;
+        case cmListFileLexer_Token_Newline:
+            info[token->line].blockDepth = blockDepth;
+            info[token->line].parenDepth = parenDepth;
+            if (parenDepth == 0)
+                expectCommand = true;
+            continue;
+        case cmListFileLexer_Token_Identifier:
+            if (parenDepth == 0 && expectCommand) {
+                const QByteArray name = QByteArray(token->text, token->length).toLower();
+                if (blockClosers.contains(name)) {
+                    line.dedent = !line.hasToken;
+                    pendingBlockDelta = -1;
+                } else if (blockMiddles.contains(name)) {
+                    line.dedent = !line.hasToken;
+                } else if (blockOpeners.contains(name)) {
+                    pendingBlockDelta = 1;
+                }
+                if (options.commandCase != NativeFormatOptions::Unchanged)
+                    caseEdits.push_back({token->line, token->column, token->length});
+                expectCommand = false;
+            }
+            break;
+        case cmListFileLexer_Token_ParenLeft:
+            ++parenDepth;
+            break;
+        case cmListFileLexer_Token_ParenRight:
+            if (!line.hasToken)
+                line.dedent = true;
+            if (--parenDepth < 0)
+                return {};
+            if (parenDepth == 0) {
+                blockDepth = std::max(0, blockDepth + pendingBlockDelta);
+                pendingBlockDelta = 0;
+            }
+            break;
+        case cmListFileLexer_Token_ArgumentUnquoted:
+        case cmListFileLexer_Token_ArgumentQuoted:
+        case cmListFileLexer_Token_ArgumentBracket:
+        case cmListFileLexer_Token_CommentBracket: {
+            const long endLine = cmListFileLexer_GetCurrentLine(lexer);
+            for (long l = token->line; l < endLine && l <= lines.size(); ++l) {
+                info[l - 1].endsInToken = true;
+                info[l].startsInToken = true;
+            }
+            break;
+        }
+        }
+        line.hasToken = true;
+    }
+
+    // An unfinished command
+    if (parenDepth != 0)
+        return {};
+
+    for (const CaseEdit &edit : caseEdits) {
+        QByteArray &line = lines[edit.line - 1];
+        for (long i = edit.column - 1; i < edit.column - 1 + edit.length && i < line.size(); ++i) {
+            const uchar c = uchar(line.at(i));
+            line[i] = char(options.commandCase == NativeFormatOptions::Lower ? std::tolower(c)
+                                                                             : std::toupper(c));
+        }
+    }
+
+    const QByteArray indentUnit = options.useTabs ? QByteArray("\t")
+                                                  : QByteArray(options.indentWidth, ' ');
+    const auto isSpace = [](char c) { return c == ' ' || c == '\t' || c == '\r'; };
+
+    QByteArrayList result;
+    result.reserve(lines.size());
+    int emptyLines = 0;
+    for (qsizetype i = 0; i < lines.size(); ++i) {
+        QByteArray line = lines.at(i);
+        const LineInfo &lineInfo = info[i];
+
+        if (!lineInfo.endsInToken) {
+            qsizetype end = line.size();
+            while (end > 0 && isSpace(line.at(end - 1)))
+                --end;
+            line.truncate(end);
+        }
+
+        if (lineInfo.startsInToken) {
+            emptyLines = 0;
+            result << line;
+            continue;
+        }
+
+        qsizetype start = 0;
+        while (start < line.size() && isSpace(line.at(start)))
+            ++start;
+        line.remove(0, start);
+
+        if (line.isEmpty()) {
+            if (++emptyLines <= options.maxEmptyLines)
+                result << line;
+            continue;
+        }
+        emptyLines = 0;
+
+        const int level = std::max(0, lineInfo.blockDepth + lineInfo.parenDepth
+                                          - (lineInfo.dedent ? 1 : 0));
+        result << indentUnit.repeated(level) + line;
+    }
+
+    QByteArray output = result.join('\n');
+    if (endsWithNewline)
+        output.append('\n');
+    return QString::fromUtf8(output);
+}
+
+} // XMakeProjectManager::Internal
+
+#ifdef WITH_TESTS
+
+#include <QTest>
+
+namespace XMakeProjectManager::Internal {
+
+class XMakeNativeFormatterTest final : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void testFormat_data();
+    void testFormat();
+    void testInvalidInput();
+};
+
+void XMakeNativeFormatterTest::testFormat_data()
+{
+    QTest::addColumn<QString>("input");
+    QTest::addColumn<int>("commandCase");
+    QTest::addColumn<QString>("expected");
+
+    QTest::newRow("indent blocks")
+        << QString("if(A)\nset(B C)\nelse()\nforeach(i ${L})\nmessage(${i})\nendforeach()\n"
+                   "endif()\n")
+        << int(NativeFormatOptions::Unchanged)
+        << QString("if(A)\n  set(B C)\nelse()\n  foreach(i ${L})\n    message(${i})\n"
+                   "  endforeach()\nendif()\n");
+    QTest::newRow("continuation lines")
+        << QString("add_executable(app\nmain.cpp\n    util.cpp\n      )\n")
+        << int(NativeFormatOptions::Unchanged)
+        << QString("add_executable(app\n  main.cpp\n  util.cpp\n)\n");
+    QTest::newRow("comments and empty lines")
+        << QString("function(f)   \n# comment\n\n\n\nreturn()\nendfunction()")
+        << int(NativeFormatOptions::Unchanged)
+        << QString("function(f)\n  # comment\n\n  return()\nendfunction()");
+    QTest::newRow("multi-line arguments are kept")
+        << QString("if(A)\nset(B \"one  \n   two\" [[\n  three]])\nendif()\n")
+        << int(NativeFormatOptions::Unchanged)
+        << QString("if(A)\n  set(B \"one  \n   two\" [[\n  three]])\nendif()\n");
+    QTest::newRow("command case")
+        << QString("IF(A)\nAdd_Library(lib STATIC a.cpp)\nENDIF()\n")
+        << int(NativeFormatOptions::Lower)
+        << QString("if(A)\n  add_library(lib STATIC a.cpp)\nendif()\n");
+}
+
+void XMakeNativeFormatterTest::testFormat()
+{
+    QFETCH(QString, input);
+    QFETCH(int, commandCase);
+    QFETCH(QString, expected);
+
+    NativeFormatOptions options;
+    options.commandCase = NativeFormatOptions::CommandCase(commandCase);
+    const std::optional<QString> formatted = formatXMakeText(input, options);
+    QVERIFY(formatted);
+    QCOMPARE(*formatted, expected);
+    QCOMPARE(formatXMakeText(*formatted, options), formatted);
+}
+
+void XMakeNativeFormatterTest::testInvalidInput()
+{
+    QVERIFY(!formatXMakeText("set(A B\n", {}));
+    QVERIFY(!formatXMakeText("set(A \"B)\n", {}));
+}
+
+QObject *createXMakeNativeFormatterTest()
+{
+    return new XMakeNativeFormatterTest;
+}
+
+} // XMakeProjectManager::Internal
+
+#endif
+
+#include "xmakenativeformatter.moc"
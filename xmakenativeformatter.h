@@ -0,0 +1,36 @@
+// Copyright (C) 2016 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only WITH Qt-GPL-exception-1.0
+
+#pragma once
+
+#include <QString>
+
+#include <optional>
+
+QT_BEGIN_NAMESPACE
+class QObject;
+QT_END_NAMESPACE
+
+namespace XMakeProjectManager::Internal {
+
+struct NativeFormatOptions
+{
+    enum CommandCase { Unchanged, Lower, Upper };
+
+    int indentWidth = 2;
+    bool useTabs = false;
+    CommandCase commandCase = Unchanged;
+    int maxEmptyLines = 1;
+};
+
+// Re-indents the commands by block and parenthesis nesting, adjusts the case of the
+// command names, removes trailing whitespace and limits the number of empty lines.
+// Comments, quoted and bracket arguments are kept as they are.
+// Returns nothing if the text can not be tokenized.
+std::optional<QString> formatXMakeText(const QString &text, const NativeFormatOptions &options);
+
+#ifdef WITH_TESTS
+QObject *createXMakeNativeFormatterTest();
+#endif
+
+} // XMakeProjectManager::Internal
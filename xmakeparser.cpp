@@ -83,7 +83,15 @@ OutputLineParser::Result XMakeParser::handleLine(const QString &line, OutputForm
                 m_skippedFirstEmptyLine = false;
         });
 
-        match = m_commonError.match(trimmedLine);
+        // The anchored patterns can only match lines starting with these literals, so check
+        // the prefix first and only run the regular expression that can possibly match.
+        const auto matchPrefixed = [&trimmedLine](const QRegularExpression &regExp,
+                                                  QLatin1String prefix) {
+            return trimmedLine.startsWith(prefix) ? regExp.match(trimmedLine)
+                                                  : QRegularExpressionMatch();
+        };
+
+        match = matchPrefixed(m_commonError, QLatin1String("XMake Error at "));
         if (match.hasMatch()) {
             const FilePath path = resolvePath(match.captured(1));
 
@@ -102,7 +110,7 @@ OutputLineParser::Result XMakeParser::handleLine(const QString &line, OutputForm
 
             return {Status::InProgress, linkSpecs};
         }
-        match = m_nextSubError.match(trimmedLine);
+        match = matchPrefixed(m_nextSubError, QLatin1String("XMake Error in "));
         if (match.hasMatch()) {
             m_lastTask = BuildSystemTask(Task::Error, QString(),
                                          absoluteFilePath(FilePath::fromUserInput(match.captured(1))));
@@ -112,7 +120,7 @@ OutputLineParser::Result XMakeParser::handleLine(const QString &line, OutputForm
             m_lines = 1;
             return {Status::InProgress, linkSpecs};
         }
-        match = m_commonWarning.match(trimmedLine);
+        match = matchPrefixed(m_commonWarning, QLatin1String("XMake Warning "));
         if (match.hasMatch()) {
             const FilePath path = resolvePath(match.captured(2));
             m_lastTask = BuildSystemTask(Task::Warning,
@@ -250,6 +258,9 @@ void XMakeParser::flush()
 #ifdef WITH_TESTS
 
 #include <projectexplorer/outputparser_test.h>
+#include <projectexplorer/taskhub.h>
+
+#include <utils/outputformatter.h>
 
 #include <QTest>
 
@@ -262,6 +273,8 @@ class XMakeParserTest final : public QObject
 private slots:
     void testXMakeParser_data();
     void testXMakeParser();
+
+    void benchmarkXMakeParser();
 };
 
 void XMakeParserTest::testXMakeParser_data()
@@ -486,6 +499,52 @@ void XMakeParserTest::testXMakeParser()
                           outputLines);
 }
 
+// A configure log as produced for a larger project: mostly status output, some plain stderr
+// chatter and a few errors and warnings with call stacks.
+static QString configureLog()
+{
+    QString log;
+    for (int i = 0; i < 2000; ++i) {
+        log += QString("-- Looking for include file header%1.h\n"
+                       "-- Looking for include file header%1.h - found\n"
+                       "-- Performing Test HAVE_FEATURE_%1 - Success\n"
+                       " * Plugin plugin%1, with CONDITION TARGET Module%1\n"
+                       "Checking whether the compiler supports flag -fsomething-%1\n")
+                   .arg(i);
+        if (i % 100 == 0) {
+            log += QString("XMake Warning (dev) at src/module%1/XMakeLists.txt:%1 (message):\n"
+                           "  this is an author warning\n"
+                           "\n"
+                           "XMake Error at src/module%1/XMakeLists.txt:%1 (add_executable):\n"
+                           "  Cannot find source file:\n"
+                           "\n"
+                           "    not-existing%1.cpp\n"
+                           "\n"
+                           "Call Stack (most recent call first):\n"
+                           "  /Qt/lib/xmake/Qt6Core/Qt6CoreMacros.xmake:549 (qt6_add_executable)\n"
+                           "  src/module%1/XMakeLists.txt:%1 (qt_add_executable)\n"
+                           "\n"
+                           "\n")
+                       .arg(i);
+        }
+    }
+    return log;
+}
+
+void XMakeParserTest::benchmarkXMakeParser()
+{
+    const QString log = configureLog();
+
+    QBENCHMARK {
+        OutputFormatter formatter;
+        formatter.addLineParser(new XMakeParser);
+        formatter.appendMessage(log, StdErrFormat);
+        formatter.flush();
+    }
+
+    TaskHub::clearTasks(ProjectExplorer::Constants::TASK_CATEGORY_BUILDSYSTEM);
+}
+
 QObject *createXMakeParserTest()
 {
     return new XMakeParserTest;
@@ -39,10 +39,51 @@ namespace XMakeProjectManager::Internal {
         return str;
     }
 
-    XMakeProcess::XMakeProcess() = default;
+    // Output is appended in blocks of at most this many lines, or after the flush interval
+    static const int outputBlockSize = 256;
+    static const int outputFlushInterval = 100; // ms
+
+    static const QString &xmakePrefix() {
+        static const QString prefix = [] {
+            auto qColorToAnsiCode = [](const QColor &color) {
+                return QString::fromLatin1("\033[38;2;%1;%2;%3m")
+                       .arg(color.red()).arg(color.green()).arg(color.blue());
+            };
+            const QColor bgColor = creatorTheme()->color(Theme::BackgroundColorNormal);
+            const QColor fgColor = creatorTheme()->color(Theme::TextColorNormal);
+            const QColor grey = StyleHelper::mergedColors(fgColor, bgColor, 80);
+            return qColorToAnsiCode(grey) + Constants::OUTPUT_PREFIX + qColorToAnsiCode(fgColor);
+        }();
+        return prefix;
+    }
+
+    XMakeProcess::XMakeProcess() {
+        m_outputFlushTimer.setSingleShot(true);
+        m_outputFlushTimer.setInterval(outputFlushInterval);
+        connect(&m_outputFlushTimer, &QTimer::timeout, this, &XMakeProcess::flushOutput);
+    }
 
     XMakeProcess::~XMakeProcess() {
         m_parser.flush();
+        flushOutput();
+    }
+
+    void XMakeProcess::appendOutputLine(const QString &line) {
+        m_pendingOutput.append(xmakePrefix() + line);
+        if (m_pendingOutput.size() >= outputBlockSize) {
+            flushOutput();
+        } else if (!m_outputFlushTimer.isActive()) {
+            m_outputFlushTimer.start();
+        }
+    }
+
+    void XMakeProcess::flushOutput() {
+        m_outputFlushTimer.stop();
+        if (m_pendingOutput.isEmpty()) {
+            return;
+        }
+        BuildSystem::appendBuildSystemOutput(m_pendingOutput.join('\n'));
+        m_pendingOutput.clear();
     }
 
     static const int failedToStartExitCode = 0xFF; // See ProcessPrivate::handleDone() impl
@@ -120,16 +161,17 @@ namespace XMakeProjectManager::Internal {
         m_process->setEnvironment(parameters.environment);
 
         m_process->setStdOutLineCallback([this](const QString &s) {
-                                             BuildSystem::appendBuildSystemOutput(addXMakePrefix(stripTrailingNewline(s)));
+                                             appendOutputLine(stripTrailingNewline(s));
                                              emit stdOutReady(s);
                                          });
 
         m_process->setStdErrLineCallback([this](const QString &s) {
                                              m_parser.appendMessage(s, StdErrFormat);
-                                             BuildSystem::appendBuildSystemOutput(addXMakePrefix(stripTrailingNewline(s)));
+                                             appendOutputLine(stripTrailingNewline(s));
                                          });
 
         connect(m_process.get(), &Process::done, this, [this] {
+                    flushOutput();
                     if (m_process->result() != ProcessResult::FinishedWithSuccess) {
                         const QString message = m_process->exitMessage();
                         BuildSystem::appendBuildSystemOutput(addXMakePrefix({ {}, message }).join('\n'));
@@ -165,16 +207,7 @@ namespace XMakeProjectManager::Internal {
     }
 
     QString addXMakePrefix(const QString &str) {
-        auto qColorToAnsiCode = [](const QColor &color) {
-            return QString::fromLatin1("\033[38;2;%1;%2;%3m")
-                   .arg(color.red()).arg(color.green()).arg(color.blue());
-        };
-        static const QColor bgColor = creatorTheme()->color(Theme::BackgroundColorNormal);
-        static const QColor fgColor = creatorTheme()->color(Theme::TextColorNormal);
-        static const QColor grey = StyleHelper::mergedColors(fgColor, bgColor, 80);
-        static const QString prefixString = qColorToAnsiCode(grey) + Constants::OUTPUT_PREFIX
-            + qColorToAnsiCode(fgColor);
-        return QString("%1%2").arg(prefixString, str);
+        return xmakePrefix() + str;
     }
 
     QStringList addXMakePrefix(const QStringList &list) {
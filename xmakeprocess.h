@@ -8,6 +8,7 @@
 #include <QElapsedTimer>
 #include <QObject>
 #include <QStringList>
+#include <QTimer>
 
 #include <memory>
 
@@ -36,9 +37,16 @@ signals:
     void stdOutReady(const QString &s);
 
 private:
+    void appendOutputLine(const QString &line);
+    void flushOutput();
+
     std::unique_ptr<Utils::Process> m_process;
     Utils::OutputFormatter m_parser;
     QElapsedTimer m_elapsed;
+
+    // Prefixed output lines, handed to the build system output in blocks
+    QStringList m_pendingOutput;
+    QTimer m_outputFlushTimer;
 };
 
 QString addXMakePrefix(const QString &str);
@@ -321,7 +321,7 @@ namespace XMakeProjectManager::Internal {
         QString xmakePrefixPath; // can be a semicolon-separated list
     };
 
-    static QMakeAndXMakePrefixPath qtInfoFromXMakeCache(const XMakeConfig &config,
+    static QMakeAndXMakePrefixPath qtInfoFromXMakeCache(const IndexedXMakeConfig &config,
                                                         const Environment &env) {
         // Qt4 way to define things (more convenient for us, so try this first;-)
         const FilePath qmake = config.filePathValueOf("QT_QMAKE_EXECUTABLE");
@@ -480,7 +480,7 @@ namespace XMakeProjectManager::Internal {
         return { qmakeLocation, resultedPrefixPath };
     }
 
-    static QVector<ToolchainDescription> extractToolchainsFromCache(const XMakeConfig &config) {
+    static QVector<ToolchainDescription> extractToolchainsFromCache(const IndexedXMakeConfig &config) {
         QVector<ToolchainDescription> result;
         bool haveCCxxCompiler = false;
         for (const XMakeConfigItem &i : config) {
@@ -528,7 +528,7 @@ namespace XMakeProjectManager::Internal {
         return result;
     }
 
-    static QString extractVisualStudioPlatformFromConfig(const XMakeConfig &config) {
+    static QString extractVisualStudioPlatformFromConfig(const IndexedXMakeConfig &config) {
         const QString xmakeGenerator = config.stringValueOf(QByteArray("XMAKE_GENERATOR"));
         QString platform;
         if (xmakeGenerator.contains("Visual Studio")) {
@@ -871,7 +871,7 @@ namespace XMakeProjectManager::Internal {
         }
 
         QString errorMessage;
-        const XMakeConfig config = XMakeConfig::fromFile(cacheFile, &errorMessage);
+        const IndexedXMakeConfig config = XMakeConfig::fromFile(cacheFile, &errorMessage);
         if (config.isEmpty() || !errorMessage.isEmpty()) {
             qCDebug(cmInputLog) << "Failed to read configuration from" << cacheFile << errorMessage;
             return result;
@@ -21,7 +21,8 @@
 #include <coreplugin/messagemanager.h>
 #include <coreplugin/modemanager.h>
 
-#include <cppeditor/cpptoolsreuse.h>
+#include <cppeditor/cppmodelmanager.h>
+#include <cppeditor/projectfile.h>
 
 #include <debugger/analyzer/analyzerconstants.h>
 #include <debugger/analyzer/analyzermanager.h>
@@ -62,7 +63,7 @@ private:
         void buildFileContextMenu();
         void buildFile(Node *node = nullptr);
         void updateBuildFileAction();
-        void enableBuildFileMenus(Node *node);
+        void enableBuildFileMenus(const Utils::FilePath &filePath, Project *project);
         void reloadXMakePresets();
 
         QAction *m_runXMakeAction;
@@ -228,7 +229,9 @@ private:
         }();
         m_reloadXMakePresetsAction->setVisible(reloadPresetsVisible);
 
-        enableBuildFileMenus(node);
+        const bool isFile = node && node->asFileNode();
+        enableBuildFileMenus(isFile ? node->filePath() : FilePath(),
+                             isFile ? ProjectTree::projectForNode(node) : nullptr);
     }
 
     void XMakeManager::clearXMakeCache(BuildSystem *buildSystem) {
@@ -279,47 +282,44 @@ private:
     }
 
     void XMakeManager::updateBuildFileAction() {
-        Node *node = nullptr;
+        FilePath filePath;
+        Project *project = nullptr;
         if (Core::IDocument *currentDocument = Core::EditorManager::currentDocument()) {
-            node = ProjectTree::nodeForFile(currentDocument->filePath());
+            filePath = currentDocument->filePath();
+            project = ProjectManager::projectForFile(filePath);
         }
-        enableBuildFileMenus(node);
+        enableBuildFileMenus(filePath, project);
     }
 
-    void XMakeManager::enableBuildFileMenus(Node *node) {
+    static XMakeBuildSystem *buildFileBuildSystem(Project *project) {
+        if (!qobject_cast<XMakeProject *>(project)) {
+            return nullptr;
+        }
+        Target *target = project->activeTarget();
+        return target ? qobject_cast<XMakeBuildSystem *>(target->buildSystem()) : nullptr;
+    }
+
+    void XMakeManager::enableBuildFileMenus(const FilePath &filePath, Project *project) {
         m_buildFileAction->setVisible(false);
         m_buildFileAction->setEnabled(false);
         m_buildFileAction->setParameter(QString());
         m_buildFileContextMenu->setEnabled(false);
 
-        if (!node) {
-            return;
-        }
-        Project *project = ProjectTree::projectForNode(node);
-        if (!project) {
-            return;
-        }
-        Target *target = project->activeTarget();
-        if (!target) {
-            return;
-        }
-        const QString generator = XMakeGeneratorKitAspect::generator(target->kit());
-        if (generator != "Ninja" && !generator.contains("Makefiles")) {
+        const XMakeBuildSystem *buildSystem = buildFileBuildSystem(project);
+        if (!buildSystem) {
             return;
         }
 
-        if (const FileNode *fileNode = node->asFileNode()) {
-            const FileType type = fileNode->fileType();
-            const bool visible = qobject_cast<XMakeProject *>(project)
-                && dynamic_cast<XMakeTargetNode *>(node->parentProjectNode())
-                && (type == FileType::Source || type == FileType::Header);
-
-            const bool enabled = visible && !BuildManager::isBuilding(project);
-            m_buildFileAction->setVisible(visible);
-            m_buildFileAction->setEnabled(enabled);
-            m_buildFileAction->setParameter(node->filePath().fileName());
-            m_buildFileContextMenu->setEnabled(enabled);
-        }
+        // Sources are looked up in the target index, headers are resolved when building
+        const bool visible = buildSystem->buildFileTarget(filePath)
+                             || (ProjectFile::isHeader(ProjectFile::classify(filePath.path()))
+                                 && project->isKnownFile(filePath));
+
+        const bool enabled = visible && !BuildManager::isBuilding(project);
+        m_buildFileAction->setVisible(visible);
+        m_buildFileAction->setEnabled(enabled);
+        m_buildFileAction->setParameter(filePath.fileName());
+        m_buildFileContextMenu->setEnabled(enabled);
     }
 
     void XMakeManager::reloadXMakePresets() {
@@ -384,80 +384,101 @@ private:
         Core::ModeManager::setFocusToCurrentMode();
     }
 
+    static QString objectExtension(const XMakeBuildSystem *buildSystem, const QString &relativeSource) {
+        const auto sourceKind = ProjectFile::classify(relativeSource);
+        const QByteArray xmakeLangExtension = ProjectFile::isCxx(sourceKind)
+                                                  ? "XMAKE_CXX_OUTPUT_EXTENSION"
+                                                  : "XMAKE_C_OUTPUT_EXTENSION";
+        const QString extension = buildSystem->configurationFromXMake().stringValueOf(xmakeLangExtension);
+        if (!extension.isEmpty()) {
+            return extension;
+        }
+
+        const auto toolchain = ProjectFile::isCxx(sourceKind)
+                                   ? ToolchainKitAspect::cxxToolchain(buildSystem->kit())
+                                   : ToolchainKitAspect::cToolchain(buildSystem->kit());
+        using namespace ProjectExplorer::Constants;
+        static QSet<Id> objIds {
+            CLANG_CL_TOOLCHAIN_TYPEID,
+            MSVC_TOOLCHAIN_TYPEID,
+            MINGW_TOOLCHAIN_TYPEID,
+        };
+        if (toolchain && objIds.contains(toolchain->typeId())) {
+            return ".obj";
+        }
+        return ".o";
+    }
+
     void XMakeManager::buildFile(Node *node) {
+        FilePath filePath;
+        Project *project = nullptr;
         if (!node) {
             Core::IDocument *currentDocument = Core::EditorManager::currentDocument();
             if (!currentDocument) {
                 return;
             }
-            const Utils::FilePath file = currentDocument->filePath();
-            node = ProjectTree::nodeForFile(file);
+            filePath = currentDocument->filePath();
+            project = ProjectManager::projectForFile(filePath);
+        } else if (const FileNode *fileNode = node->asFileNode()) {
+            filePath = fileNode->filePath();
+            project = ProjectTree::projectForNode(fileNode);
         }
-        FileNode *fileNode = node ? node->asFileNode() : nullptr;
-        if (!fileNode) {
+        XMakeBuildSystem *buildSystem = buildFileBuildSystem(project);
+        if (!buildSystem) {
             return;
         }
-        Project *project = ProjectTree::projectForNode(fileNode);
-        if (!project) {
-            return;
-        }
-        XMakeTargetNode *targetNode = dynamic_cast<XMakeTargetNode *>(fileNode->parentProjectNode());
-        if (!targetNode) {
-            return;
-        }
-        FilePath filePath = fileNode->filePath();
-        if (filePath.fileName().contains(".h")) {
-            bool wasHeader = false;
-            const FilePath sourceFile = CppEditor::correspondingHeaderOrSource(filePath, &wasHeader);
-            if (wasHeader && !sourceFile.isEmpty()) {
-                filePath = sourceFile;
+
+        FilePaths sourceFiles;
+        if (buildSystem->buildFileTarget(filePath)) {
+            sourceFiles.append(filePath);
+        } else {
+            // Build every translation unit including the header
+            const FilePaths includingFiles = CppModelManager::snapshot().filesDependingOn(filePath);
+            for (const FilePath &file : includingFiles) {
+                if (buildSystem->buildFileTarget(file)) {
+                    sourceFiles.append(file);
+                }
             }
         }
-        Target *target = project->activeTarget();
-        QTC_ASSERT(target, return );
-        const QString generator = XMakeGeneratorKitAspect::generator(target->kit());
-        const QString relativeSource = filePath.relativeChildPath(targetNode->filePath()).toString();
-        Utils::FilePath targetBase;
-        BuildConfiguration *bc = target->activeBuildConfiguration();
-        QTC_ASSERT(bc, return );
-        if (generator == "Ninja") {
-            const Utils::FilePath relativeBuildDir = targetNode->buildDirectory().relativeChildPath(
-                bc->buildDirectory());
-            targetBase = relativeBuildDir / "XMakeFiles" / (targetNode->displayName() + ".dir");
-        } else if (!generator.contains("Makefiles")) {
+        if (sourceFiles.isEmpty()) {
             Core::MessageManager::writeFlashing(addXMakePrefix(
-                Tr::tr("Build File is not supported for generator \"%1\"").arg(generator)));
+                Tr::tr("No file of the project to build for \"%1\".").arg(filePath.toUserOutput())));
             return;
         }
 
-        auto cbc = static_cast<XMakeBuildSystem *>(bc->buildSystem());
-        const QString sourceFile = targetBase.pathAppended(relativeSource).toString();
-        const QString objExtension = [&]() -> QString {
-            const auto sourceKind = ProjectFile::classify(relativeSource);
-            const QByteArray xmakeLangExtension = ProjectFile::isCxx(sourceKind)
-                                                      ? "XMAKE_CXX_OUTPUT_EXTENSION"
-                                                      : "XMAKE_C_OUTPUT_EXTENSION";
-            const QString extension = cbc->configurationFromXMake().stringValueOf(xmakeLangExtension);
-            if (!extension.isEmpty()) {
-                return extension;
+        BuildConfiguration *bc = buildSystem->buildConfiguration();
+        QTC_ASSERT(bc, return );
+
+        // Only Ninja and Makefiles have a build target per object file. The file API does not
+        // report object paths, so other generators build the targets owning the files.
+        const QString generator = XMakeGeneratorKitAspect::generator(buildSystem->kit());
+        if (generator != "Ninja" && !generator.contains("Makefiles")) {
+            QStringList ownerTargets;
+            for (const FilePath &sourceFile : std::as_const(sourceFiles)) {
+                const QString targetName = buildSystem->buildFileTarget(sourceFile)->targetName;
+                if (!ownerTargets.contains(targetName)) {
+                    ownerTargets.append(targetName);
+                }
             }
+            buildSystem->buildXMakeTargets(ownerTargets);
+            return;
+        }
 
-            const auto toolchain = ProjectFile::isCxx(sourceKind)
-                                       ? ToolchainKitAspect::cxxToolchain(target->kit())
-                                       : ToolchainKitAspect::cToolchain(target->kit());
-            using namespace ProjectExplorer::Constants;
-            static QSet<Id> objIds {
-                CLANG_CL_TOOLCHAIN_TYPEID,
-                MSVC_TOOLCHAIN_TYPEID,
-                MINGW_TOOLCHAIN_TYPEID,
-            };
-            if (objIds.contains(toolchain->typeId())) {
-                return ".obj";
+        QStringList objectTargets;
+        for (const FilePath &sourceFile : std::as_const(sourceFiles)) {
+            const XMakeBuildSystem::BuildFileTarget target = *buildSystem->buildFileTarget(sourceFile);
+            const QString relativeSource = sourceFile.relativeChildPath(target.sourceDirectory).toString();
+            Utils::FilePath targetBase;
+            if (generator == "Ninja") {
+                const Utils::FilePath relativeBuildDir = target.buildDirectory.relativeChildPath(
+                    bc->buildDirectory());
+                targetBase = relativeBuildDir / "XMakeFiles" / (target.targetName + ".dir");
             }
-            return ".o";
-        }();
+            objectTargets.append(targetBase.pathAppended(relativeSource).toString()
+                                 + objectExtension(buildSystem, relativeSource));
+        }
 
-        cbc->buildXMakeTarget(sourceFile + objExtension);
+        buildSystem->buildXMakeTargets(objectTargets);
     }
 
     void XMakeManager::buildFileContextMenu() {
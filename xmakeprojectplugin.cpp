@@ -5,9 +5,12 @@
 #include "xmakebuildstep.h"
 #include "xmakebuildsystem.h"
 #include "xmakeeditor.h"
+#include "xmakefileast.h"
+#include "xmakefilecompletionassist.h"
 #include "xmakeformatter.h"
 #include "xmakeinstallstep.h"
 #include "xmakelocatorfilter.h"
+#include "xmakenativeformatter.h"
 #include "xmakekitaspect.h"
 #include "xmakeparser.h"
 #include "xmakeproject.h"
@@ -58,14 +61,17 @@ namespace XMakeProjectManager::Internal {
             setupXMakeInstallStep();
 
             setupXMakeEditor();
+            setupXMakeFileCompletion(this);
 
             setupXMakeLocatorFilters();
-            setupXMakeFormatter();
+            setupXMakeFormatter(this);
 
             setupXMakeManager();
 
 #ifdef WITH_TESTS
             addTestCreator(createXMakeConfigTest);
+            addTestCreator(createXMakeFileAstTest);
+            addTestCreator(createXMakeNativeFormatterTest);
             addTestCreator(createXMakeParserTest);
             addTestCreator(createXMakeProjectImporterTest);
 #endif
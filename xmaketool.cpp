@@ -9,13 +9,20 @@
 #include <coreplugin/icore.h>
 #include <coreplugin/helpmanager.h>
 
+#include <extensionsystem/pluginmanager.h>
+
 #include <utils/algorithm.h>
+#include <utils/async.h>
 #include <utils/environment.h>
 #include <utils/process.h>
 #include <utils/qtcassert.h>
 #include <utils/temporarydirectory.h>
 
+#include <QCoreApplication>
+#include <QCryptographicHash>
 #include <QDir>
+#include <QFuture>
+#include <QJsonArray>
 #include <QJsonDocument>
 #include <QJsonObject>
 #include <QLoggingCategory>
@@ -25,6 +32,7 @@
 #include <QUuid>
 #include <QMessageBox>
 
+#include <atomic>
 #include <memory>
 
 using namespace Utils;
@@ -69,6 +77,160 @@ namespace XMakeProjectManager {
             }
         }
 
+// --------------------------------------------------------------------
+// Keywords cache:
+// --------------------------------------------------------------------
+
+        const int KEYWORDS_CACHE_FORMAT = 1;
+
+        class KeywordsCache {
+public:
+            QByteArray version;
+            XMakeKeywords keywords;
+        };
+
+        using KeywordsMap = QMap<QString, FilePath> XMakeKeywords::*;
+        const std::pair<const char *, KeywordsMap> keywordsMaps[] = {
+            { "variables", &XMakeKeywords::variables },
+            { "functions", &XMakeKeywords::functions },
+            { "properties", &XMakeKeywords::properties },
+            { "environmentVariables", &XMakeKeywords::environmentVariables },
+            { "directoryProperties", &XMakeKeywords::directoryProperties },
+            { "sourceProperties", &XMakeKeywords::sourceProperties },
+            { "targetProperties", &XMakeKeywords::targetProperties },
+            { "testProperties", &XMakeKeywords::testProperties },
+            { "includeStandardModules", &XMakeKeywords::includeStandardModules },
+            { "findModules", &XMakeKeywords::findModules },
+            { "policies", &XMakeKeywords::policies },
+        };
+
+        static FilePath keywordsCacheFile(const FilePath &executable) {
+            const QByteArray hash = QCryptographicHash::hash(executable.toString().toUtf8(),
+                                                             QCryptographicHash::Sha1).toHex();
+            return Core::ICore::cacheResourcePath("xmake/keywords-" + QString::fromLatin1(hash)
+                                                  + ".json");
+        }
+
+        // The keywords depend on the executable and on the highlighter definitions shipped
+        // with Qt Creator, the version of the executable is checked when the cache is used.
+        static QString keywordsCacheKey(const FilePath &executable) {
+            return QString("%1|%2|%3")
+                .arg(executable.toString())
+                .arg(executable.lastModified().toMSecsSinceEpoch())
+                .arg(QCoreApplication::applicationVersion());
+        }
+
+        static std::optional<KeywordsCache> readKeywordsCache(const FilePath &executable) {
+            if (executable.isEmpty() || executable.needsDevice()) {
+                return {};
+            }
+
+            const expected_str<QByteArray> contents = keywordsCacheFile(executable).fileContents();
+            if (!contents) {
+                return {};
+            }
+
+            const QJsonObject root = QJsonDocument::fromJson(*contents).object();
+            if (root.value("format").toInt() != KEYWORDS_CACHE_FORMAT
+                || root.value("key").toString() != keywordsCacheKey(executable)) {
+                return {};
+            }
+
+            KeywordsCache cache;
+            cache.version = root.value("version").toString().toUtf8();
+            for (const auto &[name, member] : keywordsMaps) {
+                const QJsonObject map = root.value(QLatin1String(name)).toObject();
+                for (auto it = map.constBegin(); it != map.constEnd(); ++it) {
+                    (cache.keywords.*member).insert(it.key(),
+                                                    FilePath::fromString(it.value().toString()));
+                }
+            }
+            const QJsonObject functionArgs = root.value("functionArgs").toObject();
+            for (auto it = functionArgs.constBegin(); it != functionArgs.constEnd(); ++it) {
+                const QJsonArray arguments = it.value().toArray();
+                cache.keywords.functionArgs.insert(it.key(),
+                                                   transform<QStringList>(arguments,
+                                                                          [](const QJsonValue &v) {
+                                                                              return v.toString();
+                                                                          }));
+            }
+            for (const QJsonValue &expression : root.value("generatorExpressions").toArray()) {
+                cache.keywords.generatorExpressions.insert(expression.toString());
+            }
+            return cache;
+        }
+
+        static void writeKeywordsCache(const FilePath &executable,
+                                       const QByteArray &version,
+                                       const XMakeKeywords &keywords) {
+            if (executable.isEmpty() || executable.needsDevice()) {
+                return;
+            }
+
+            QJsonObject root;
+            root.insert("format", KEYWORDS_CACHE_FORMAT);
+            root.insert("key", keywordsCacheKey(executable));
+            root.insert("version", QString::fromUtf8(version));
+            for (const auto &[name, member] : keywordsMaps) {
+                QJsonObject map;
+                const QMap<QString, FilePath> &keywordsMap = keywords.*member;
+                for (auto it = keywordsMap.constBegin(); it != keywordsMap.constEnd(); ++it) {
+                    map.insert(it.key(), it.value().toString());
+                }
+                root.insert(QLatin1String(name), map);
+            }
+            QJsonObject functionArgs;
+            for (auto it = keywords.functionArgs.constBegin();
+                 it != keywords.functionArgs.constEnd();
+                 ++it) {
+                functionArgs.insert(it.key(), QJsonArray::fromStringList(it.value()));
+            }
+            root.insert("functionArgs", functionArgs);
+            root.insert("generatorExpressions",
+                        QJsonArray::fromStringList(Utils::toList(keywords.generatorExpressions)));
+
+            const FilePath cacheFile = keywordsCacheFile(executable);
+            cacheFile.parentDir().ensureWritableDir();
+            const expected_str<qint64> written = cacheFile.writeFileContents(
+                QJsonDocument(root).toJson(QJsonDocument::Compact));
+            if (!written) {
+                qCDebug(xmakeToolLog) << "Failed to write the keywords cache:" << written.error();
+            }
+        }
+
+// --------------------------------------------------------------------
+// Capabilities cache:
+// --------------------------------------------------------------------
+
+        // Output of "xmake -h" by binary, so that tools sharing a binary run it only once
+        class CapabilitiesCache {
+public:
+            QMutex mutex;
+            QHash<QString, QString> outputs;
+        };
+
+        static CapabilitiesCache &capabilitiesCache() {
+            static CapabilitiesCache cache;
+            return cache;
+        }
+
+        static QString binaryIdentity(const FilePath &executable) {
+            return QString("%1|%2|%3")
+                .arg(executable.toString())
+                .arg(executable.lastModified().toMSecsSinceEpoch())
+                .arg(executable.fileSize());
+        }
+
+        static void setupXMakeProcess(Process &xmake,
+                                      const FilePath &executable,
+                                      const QStringList &args) {
+            xmake.setDisableUnixTerminal();
+            Environment env = executable.deviceEnvironment();
+            env.setupEnglishOutput();
+            xmake.setEnvironment(env);
+            xmake.setCommand({ executable, args });
+        }
+
 // --------------------------------------------------------------------
 // XMakeIntrospectionData:
 // --------------------------------------------------------------------
@@ -81,12 +243,18 @@ public:
 
         class IntrospectionData {
 public:
-            bool m_didAttemptToRun = false;
+            // Set once the capabilities below are complete, they do not change afterwards.
+            // Probing them is serialized by m_capabilitiesMutex.
+            std::atomic<bool> m_didAttemptToRun = false;
+            QMutex m_capabilitiesMutex;
             bool m_haveCapabilitites = true;
-            bool m_haveKeywords = false;
+            // Set once m_keywords is complete, which is written under m_keywordsMutex
+            std::atomic<bool> m_haveKeywords = false;
+            bool m_didReadKeywordsCache = false;
 
             QList<XMakeTool::Generator> m_generators;
             XMakeKeywords m_keywords;
+            QFuture<std::optional<KeywordsCache>> m_cachedKeywords;
             QMutex m_keywordsMutex;
             QVector<FileApi> m_fileApis;
             XMakeTool::Version m_version;
@@ -160,13 +328,12 @@ public:
         return m_introspection->m_haveCapabilitites && !m_introspection->m_fileApis.isEmpty();
     }
 
+    void XMakeTool::setupXMakeProcess(Process &xmake, const QStringList &args) const {
+        Internal::setupXMakeProcess(xmake, xmakeExecutable(), args);
+    }
+
     void XMakeTool::runXMake(Process &xmake, const QStringList &args, int timeoutS) const {
-        const FilePath executable = xmakeExecutable();
-        xmake.setDisableUnixTerminal();
-        Environment env = executable.deviceEnvironment();
-        env.setupEnglishOutput();
-        xmake.setEnvironment(env);
-        xmake.setCommand({ executable, args });
+        setupXMakeProcess(xmake, args);
         xmake.runBlocking(std::chrono::seconds(timeoutS));
     }
 
@@ -234,16 +401,47 @@ public:
     }
 
     XMakeKeywords XMakeTool::keywords() {
+        if (!m_introspection) {
+            return {};
+        }
+
+        // The cache key covers the binary, so a warm cache is used without the blocking
+        // capabilities probe. The version is compared only if the tool is probed already.
+        if (!m_introspection->m_haveKeywords) {
+            QMutexLocker locker(&m_introspection->m_keywordsMutex);
+            if (!m_introspection->m_haveKeywords && !m_introspection->m_didReadKeywordsCache) {
+                const std::optional<Internal::KeywordsCache> cache
+                    = m_introspection->m_cachedKeywords.isValid()
+                          ? m_introspection->m_cachedKeywords.result()
+                          : Internal::readKeywordsCache(xmakeExecutable());
+                m_introspection->m_cachedKeywords = {};
+                m_introspection->m_didReadKeywordsCache = true;
+                if (cache
+                    && (!hasProbedCapabilities()
+                        || cache->version == m_introspection->m_version.fullVersion)) {
+                    m_introspection->m_keywords = cache->keywords;
+                    m_introspection->m_haveKeywords = true;
+                    XMakeToolManager::prewarmRstToolTips(m_introspection->m_keywords);
+                }
+            }
+        }
+        if (m_introspection->m_haveKeywords) {
+            return m_introspection->m_keywords;
+        }
+
         if (!isValid()) {
             return {};
         }
 
-        if (!m_introspection->m_haveKeywords && m_introspection->m_haveCapabilitites) {
+        if (m_introspection->m_haveCapabilitites) {
             QMutexLocker locker(&m_introspection->m_keywordsMutex);
             if (m_introspection->m_haveKeywords) {
                 return m_introspection->m_keywords;
             }
 
+            const FilePath executable = xmakeExecutable();
+            const QByteArray version = m_introspection->m_version.fullVersion;
+
             Process proc;
 
             const FilePath findXMakeRoot = TemporaryDirectory::masterDirectoryFilePath()
@@ -279,9 +477,11 @@ public:
                 // Environment Variables
                 { "Help/envvar", m_introspection->m_keywords.environmentVariables },
             };
+            bool haveHelpFiles = false;
             for (auto &i : introspections) {
                 const FilePaths files = xmakeRoot.pathAppended(i.helpPath)
                     .dirEntries({ { "*.rst" }, QDir::Files }, QDir::Name);
+                haveHelpFiles = haveHelpFiles || !files.isEmpty();
                 for (const auto &filePath : files) {
                     i.targetMap[filePath.completeBaseName()] = filePath;
                 }
@@ -312,11 +512,34 @@ public:
             }
 
             m_introspection->m_haveKeywords = true;
+            // Without the help files the keywords are incomplete, the next session tries again
+            if (!xmakeRoot.isEmpty() && haveHelpFiles) {
+                Internal::writeKeywordsCache(executable, version, m_introspection->m_keywords);
+            }
+            XMakeToolManager::prewarmRstToolTips(m_introspection->m_keywords);
         }
 
         return m_introspection->m_keywords;
     }
 
+    void XMakeTool::preloadKeywords() {
+        if (m_executable.isEmpty() || m_executable.needsDevice() || !m_introspection) {
+            return;
+        }
+
+        QMutexLocker locker(&m_introspection->m_keywordsMutex);
+        if (m_introspection->m_haveKeywords || m_introspection->m_didReadKeywordsCache
+            || m_introspection->m_cachedKeywords.isValid()) {
+            return;
+        }
+
+        m_introspection->m_cachedKeywords = Utils::asyncRun([executable = m_executable] {
+            return Internal::readKeywordsCache(XMakeTool::xmakeExecutable(executable));
+        });
+        ExtensionSystem::PluginManager::futureSynchronizer()->addFuture(
+            m_introspection->m_cachedKeywords);
+    }
+
     bool XMakeTool::hasFileApi() const {
         return isValid() ? !m_introspection->m_fileApis.isEmpty() : false;
     }
@@ -432,13 +655,13 @@ public:
 
     void XMakeTool::readInformation() const {
         QTC_ASSERT(m_introspection, return );
-        if (!m_introspection->m_haveCapabilitites && m_introspection->m_didAttemptToRun) {
+        QMutexLocker locker(&m_introspection->m_capabilitiesMutex);
+        if (m_introspection->m_didAttemptToRun) {
             return;
         }
 
-        m_introspection->m_didAttemptToRun = true;
-
         fetchFromCapabilities();
+        m_introspection->m_didAttemptToRun = true;
     }
 
     static QStringList parseDefinition(const QString &definition) {
@@ -621,13 +844,91 @@ public:
         return moduleFunctions;
     }
 
+    bool XMakeTool::hasProbedCapabilities() const {
+        return !m_introspection || m_introspection->m_didAttemptToRun;
+    }
+
+    void XMakeTool::setupCapabilitiesProbe(Process &xmake) const {
+        setupXMakeProcess(xmake, { "-h" });
+    }
+
+    void XMakeTool::handleCapabilitiesProbe(const Process &xmake) {
+        // The tool may have been probed synchronously or changed while the probe was running
+        const FilePath executable = xmake.commandLine().executable();
+        if (hasProbedCapabilities() || executable != xmakeExecutable()) {
+            return;
+        }
+
+        QMutexLocker locker(&m_introspection->m_capabilitiesMutex);
+        if (m_introspection->m_didAttemptToRun) {
+            return;
+        }
+        applyCapabilities(Internal::binaryIdentity(executable), xmake);
+        m_introspection->m_didAttemptToRun = true;
+    }
+
+    std::optional<QString> XMakeTool::probeCapabilities(const FilePath &executable) {
+        const FilePath resolvedExecutable = xmakeExecutable(executable);
+        Process xmake;
+        Internal::setupXMakeProcess(xmake, resolvedExecutable, { "-h" });
+        xmake.runBlocking(std::chrono::seconds(10));
+        if (xmake.result() != ProcessResult::FinishedWithSuccess) {
+            return {};
+        }
+
+        const QString output = xmake.cleanedStdOut();
+        Internal::CapabilitiesCache &cache = Internal::capabilitiesCache();
+        QMutexLocker locker(&cache.mutex);
+        cache.outputs.insert(Internal::binaryIdentity(resolvedExecutable), output);
+        return output;
+    }
+
+    void XMakeTool::setProbedCapabilities(const QString &output) {
+        if (hasProbedCapabilities()) {
+            return;
+        }
+
+        QMutexLocker locker(&m_introspection->m_capabilitiesMutex);
+        if (m_introspection->m_didAttemptToRun) {
+            return;
+        }
+        m_introspection->m_haveCapabilitites = true;
+        parseFromCapabilities(output);
+        m_introspection->m_didAttemptToRun = true;
+    }
+
     void XMakeTool::fetchFromCapabilities() const {
+        const QString identity = Internal::binaryIdentity(xmakeExecutable());
+        Internal::CapabilitiesCache &cache = Internal::capabilitiesCache();
+        std::optional<QString> output;
+        {
+            QMutexLocker locker(&cache.mutex);
+            const auto it = cache.outputs.constFind(identity);
+            if (it != cache.outputs.cend()) {
+                output = *it;
+            }
+        }
+        if (output) {
+            m_introspection->m_haveCapabilitites = true;
+            parseFromCapabilities(*output);
+            return;
+        }
+
         Process xmake;
         runXMake(xmake, { "-h" }, 10);
+        applyCapabilities(identity, xmake);
+    }
 
+    void XMakeTool::applyCapabilities(const QString &binaryIdentity, const Process &xmake) const {
         if (xmake.result() == ProcessResult::FinishedWithSuccess) {
             m_introspection->m_haveCapabilitites = true;
-            parseFromCapabilities(xmake.cleanedStdOut());
+            const QString output = xmake.cleanedStdOut();
+            Internal::CapabilitiesCache &cache = Internal::capabilitiesCache();
+            {
+                QMutexLocker locker(&cache.mutex);
+                cache.outputs.insert(binaryIdentity, output);
+            }
+            parseFromCapabilities(output);
         } else {
             qCCritical(xmakeToolLog) << "Fetching capabilities failed: " << xmake.allOutput() << xmake.error();
             m_introspection->m_haveCapabilitites = false;
@@ -91,6 +91,15 @@ public:
     bool autoCreateBuildDirectory() const;
     QList<Generator> supportedGenerators() const;
     XMakeKeywords keywords();
+    // Reads the keywords cached by an earlier session in the background
+    void preloadKeywords();
+    // Probing the capabilities without blocking, see XMakeToolManager::probeXMakeTools()
+    bool hasProbedCapabilities() const;
+    void setupCapabilitiesProbe(Utils::Process &xmake) const;
+    void handleCapabilitiesProbe(const Utils::Process &xmake);
+    // Blocking, meant to be run on a worker thread. Returns the output of "xmake -h".
+    static std::optional<QString> probeCapabilities(const Utils::FilePath &executable);
+    void setProbedCapabilities(const QString &output);
     bool hasFileApi() const;
     Version version() const;
     QString versionDisplay() const;
@@ -115,12 +124,14 @@ public:
 private:
     void readInformation() const;
 
+    void setupXMakeProcess(Utils::Process &proc, const QStringList &args) const;
     void runXMake(Utils::Process &proc, const QStringList &args, int timeoutS = 1) const;
     void parseFunctionDetailsOutput(const QString &output);
     QStringList parseVariableOutput(const QString &output);
     QStringList parseSyntaxHighlightingXml();
 
     void fetchFromCapabilities() const;
+    void applyCapabilities(const QString &binaryIdentity, const Utils::Process &xmake) const;
     void parseFromCapabilities(const QString &input) const;
 
     // Note: New items here need also be handled in XMakeToolItemModel::apply()
@@ -20,14 +20,22 @@
 #include <projectexplorer/projecttree.h>
 #include <projectexplorer/target.h>
 
+#include <utils/async.h>
 #include <utils/environment.h>
 #include <utils/pointeralgorithm.h>
+#include <utils/process.h>
 #include <utils/qtcassert.h>
 
 #include <nanotrace/nanotrace.h>
 
+#include <solutions/tasking/tasktree.h>
+
+#include <QCache>
 #include <QCryptographicHash>
 #include <QStandardPaths>
+#include <QtConcurrent>
+
+#include <array>
 #include <stack>
 
 #ifdef Q_OS_WIN
@@ -71,6 +79,7 @@ typedef struct _REPARSE_DATA_BUFFER {
 
 using namespace Core;
 using namespace ProjectExplorer;
+using namespace Tasking;
 using namespace Utils;
 
 namespace XMakeProjectManager {
@@ -87,6 +96,8 @@ public:
     Internal::XMakeToolSettingsAccessor m_accessor;
     FilePath m_junctionsDir;
     int m_junctionsHashLength = 32;
+    std::unique_ptr<TaskTree> m_probeTaskTree;
+    bool m_probeAgain = false;
 
     XMakeToolManagerPrivate();
 };
@@ -222,6 +233,57 @@ public:
     }
 };
 
+// Rendered rst help tooltips. The cache is bounded and split into shards with their own lock,
+// so that lookups from the completion thread and from hovers rarely wait for each other.
+class RstToolTipCache
+{
+public:
+    std::optional<QString> toolTip(const FilePath &helpFile)
+    {
+        Shard &s = shard(helpFile);
+        QMutexLocker locker(&s.mutex);
+        if (const QString *toolTip = s.toolTips.object(helpFile))
+            return *toolTip;
+        return {};
+    }
+
+    void insert(const FilePath &helpFile, const QString &toolTip)
+    {
+        Shard &s = shard(helpFile);
+        QMutexLocker locker(&s.mutex);
+        s.toolTips.insert(helpFile, new QString(toolTip));
+    }
+
+private:
+    struct Shard
+    {
+        QMutex mutex;
+        QCache<FilePath, QString> toolTips{512};
+    };
+
+    Shard &shard(const FilePath &helpFile) { return m_shards[qHash(helpFile) % m_shards.size()]; }
+
+    std::array<Shard, 8> m_shards;
+};
+
+static RstToolTipCache &rstToolTipCache()
+{
+    static RstToolTipCache cache;
+    return cache;
+}
+
+static QString renderRstToolTip(const FilePath &helpFile)
+{
+    auto content = helpFile.fileContents(1024).value_or(QByteArray());
+    content.replace("\r\n", "\n");
+
+    HtmlHandler handler;
+    rst::Parser parser(&handler);
+    parser.Parse(content.left(content.lastIndexOf('\n')));
+
+    return handler.content();
+}
+
 static XMakeToolManagerPrivate *d = nullptr;
 static XMakeToolManager *m_instance = nullptr;
 
@@ -271,6 +333,7 @@ bool XMakeToolManager::registerXMakeTool(std::unique_ptr<XMakeTool> &&tool)
     }), return false);
 
     d->m_xmakeTools.emplace_back(std::move(tool));
+    d->m_xmakeTools.back()->preloadKeywords();
 
     emit m_instance->xmakeAdded(toolId);
 
@@ -278,6 +341,8 @@ bool XMakeToolManager::registerXMakeTool(std::unique_ptr<XMakeTool> &&tool)
 
     updateDocumentation();
 
+    probeXMakeTools();
+
     return true;
 }
 
@@ -343,6 +408,10 @@ void XMakeToolManager::restoreXMakeTools()
 
     emit m_instance->xmakeToolsLoaded();
 
+    for (const std::unique_ptr<XMakeTool> &tool : d->m_xmakeTools)
+        tool->preloadKeywords();
+    probeXMakeTools();
+
     // Store the default XMake tool "Autorun XMake" value globally
     // TODO: Remove in Qt Creator 13
     Internal::XMakeSpecificSettings &s = Internal::settings();
@@ -353,6 +422,49 @@ void XMakeToolManager::restoreXMakeTools()
     }
 }
 
+// Runs "xmake -h" for all tools that were not asked for their capabilities yet, in parallel
+// and without blocking. xmakeUpdated() is emitted for each tool that got probed.
+void XMakeToolManager::probeXMakeTools()
+{
+    if (d->m_probeTaskTree) {
+        d->m_probeAgain = true;
+        return;
+    }
+
+    QList<GroupItem> tasks{parallel, finishAllAndSuccess};
+    for (const std::unique_ptr<XMakeTool> &tool : d->m_xmakeTools) {
+        if (tool->hasProbedCapabilities())
+            continue;
+
+        const Id id = tool->id();
+        const auto onSetup = [id](Process &process) {
+            const XMakeTool *tool = findById(id);
+            if (!tool || tool->hasProbedCapabilities())
+                return SetupResult::StopWithSuccess;
+            tool->setupCapabilitiesProbe(process);
+            return SetupResult::Continue;
+        };
+        const auto onDone = [id](const Process &process) {
+            XMakeTool *tool = findById(id);
+            if (!tool)
+                return;
+            tool->handleCapabilitiesProbe(process);
+            emit m_instance->xmakeUpdated(id);
+        };
+        tasks.append(ProcessTask(onSetup, onDone).withTimeout(std::chrono::seconds(10)));
+    }
+    if (tasks.size() == 2)
+        return;
+
+    d->m_probeTaskTree.reset(new TaskTree(Group(tasks)));
+    QObject::connect(d->m_probeTaskTree.get(), &TaskTree::done, m_instance, [] {
+        d->m_probeTaskTree.release()->deleteLater();
+        if (std::exchange(d->m_probeAgain, false))
+            probeXMakeTools();
+    });
+    d->m_probeTaskTree->start();
+}
+
 void XMakeToolManager::updateDocumentation()
 {
     const QList<XMakeTool *> tools = xmakeTools();
@@ -425,24 +537,54 @@ static void createJunction(const FilePath &from, const FilePath &to)
 
 QString XMakeToolManager::toolTipForRstHelpFile(const FilePath &helpFile)
 {
-    static QHash<FilePath, QString> map;
-    static QMutex mutex;
-    QMutexLocker locker(&mutex);
+    RstToolTipCache &cache = rstToolTipCache();
+    if (const std::optional<QString> toolTip = cache.toolTip(helpFile))
+        return *toolTip;
 
-    if (map.contains(helpFile))
-        return map.value(helpFile);
-
-    auto content = helpFile.fileContents(1024).value_or(QByteArray());
-    content.replace("\r\n", "\n");
+    const QString toolTip = renderRstToolTip(helpFile);
+    cache.insert(helpFile, toolTip);
+    return toolTip;
+}
 
-    HtmlHandler handler;
-    rst::Parser parser(&handler);
-    parser.Parse(content.left(content.lastIndexOf('\n')));
+// Renders the tooltips of the functions and variables in the background, so that hovering
+// them does not wait for the help files to be read. The XMAKE_* and PROJECT_* variables come
+// first, and the total stays well within the tooltip cache. Called once per keyword set,
+// from any thread.
+void XMakeToolManager::prewarmRstToolTips(const XMakeKeywords &keywords)
+{
+    const int maxPrewarmedToolTips = 2048;
 
-    const QString tooltip = handler.content();
+    FilePaths helpFiles;
+    for (const FilePath &helpFile : keywords.functions) {
+        if (!helpFile.isEmpty())
+            helpFiles << helpFile;
+    }
+    FilePaths otherVariables;
+    for (auto it = keywords.variables.cbegin(); it != keywords.variables.cend(); ++it) {
+        if (it.value().isEmpty())
+            continue;
+        if (it.key().startsWith("XMAKE_") || it.key().startsWith("PROJECT_"))
+            helpFiles << it.value();
+        else
+            otherVariables << it.value();
+    }
+    helpFiles << otherVariables;
+    helpFiles = helpFiles.mid(0, maxPrewarmedToolTips);
+    if (helpFiles.isEmpty())
+        return;
 
-    map[helpFile] = tooltip;
-    return tooltip;
+    QTC_ASSERT(m_instance, return);
+    // The future synchronizer lives in the GUI thread and cancels the task on shutdown
+    QMetaObject::invokeMethod(m_instance, [helpFiles] {
+        ExtensionSystem::PluginManager::futureSynchronizer()->addFuture(
+            Utils::asyncRun([helpFiles](QPromise<void> &promise) {
+                for (const FilePath &helpFile : helpFiles) {
+                    if (promise.isCanceled())
+                        return;
+                    toolTipForRstHelpFile(helpFile);
+                }
+            }));
+    });
 }
 
 FilePath XMakeToolManager::mappedFilePath(const FilePath &path)
@@ -482,20 +624,62 @@ FilePath XMakeToolManager::mappedFilePath(const FilePath &path)
     return fullHashPath.exists() ? fullHashPath : path;
 }
 
+static std::unique_ptr<XMakeTool> createDetectedXMakeTool(const Id &id,
+                                                          const FilePath &xmakePath,
+                                                          const QString &detectionSource)
+{
+    auto newTool = std::make_unique<XMakeTool>(XMakeTool::ManualDetection, id);
+    newTool->setFilePath(xmakePath);
+    newTool->setDetectionSource(detectionSource);
+    newTool->setDisplayName(xmakePath.toUserOutput());
+    return newTool;
+}
+
+// The search paths are checked in parallel, which matters for devices where every file
+// access is a round trip. Binaries reachable through several search paths are only
+// registered once, and their capabilities are probed in the same batch.
 QList<Id> XMakeToolManager::autoDetectXMakeForDevice(const FilePaths &searchPaths,
                                                 const QString &detectionSource,
                                                 QString *logMessage)
 {
+    struct Candidate
+    {
+        FilePath xmake;
+        FilePath realPath;
+        std::optional<QString> capabilities;
+    };
+
+    const QList<std::optional<Candidate>> found = QtConcurrent::blockingMapped(
+        searchPaths, [](const FilePath &path) -> std::optional<Candidate> {
+            const FilePath xmake = path.pathAppended("xmake").withExecutableSuffix();
+            if (!xmake.isExecutableFile())
+                return {};
+            return Candidate{xmake, xmake.canonicalPath(), {}};
+        });
+
+    QList<Candidate> candidates;
+    QSet<FilePath> realPaths;
+    for (const std::optional<Candidate> &candidate : found) {
+        if (candidate && Utils::insert(realPaths, candidate->realPath))
+            candidates.append(*candidate);
+    }
+
+    QtConcurrent::blockingMap(candidates, [](Candidate &candidate) {
+        candidate.capabilities = XMakeTool::probeCapabilities(candidate.xmake);
+    });
+
     QList<Id> result;
     QStringList messages{Tr::tr("Searching XMake binaries...")};
-    for (const FilePath &path : searchPaths) {
-        const FilePath xmake = path.pathAppended("xmake").withExecutableSuffix();
-        if (xmake.isExecutableFile()) {
-            const Id currentId = registerXMakeByPath(xmake, detectionSource);
-            if (currentId.isValid())
-                result.push_back(currentId);
-            messages.append(Tr::tr("Found \"%1\"").arg(xmake.toUserOutput()));
+    for (const Candidate &candidate : std::as_const(candidates)) {
+        const Id id = Id::fromString(candidate.xmake.toUserOutput());
+        if (!findById(id)) {
+            auto newTool = createDetectedXMakeTool(id, candidate.xmake, detectionSource);
+            if (candidate.capabilities)
+                newTool->setProbedCapabilities(*candidate.capabilities);
+            registerXMakeTool(std::move(newTool));
         }
+        result.push_back(id);
+        messages.append(Tr::tr("Found \"%1\"").arg(candidate.xmake.toUserOutput()));
     }
     if (logMessage)
         *logMessage = messages.join('\n');
@@ -512,10 +696,7 @@ Id XMakeToolManager::registerXMakeByPath(const FilePath &xmakePath, const QStrin
     if (xmakeTool)
         return xmakeTool->id();
 
-    auto newTool = std::make_unique<XMakeTool>(XMakeTool::ManualDetection, id);
-    newTool->setFilePath(xmakePath);
-    newTool->setDetectionSource(detectionSource);
-    newTool->setDisplayName(xmakePath.toUserOutput());
+    auto newTool = createDetectedXMakeTool(id, xmakePath, detectionSource);
     id = newTool->id();
     registerXMakeTool(std::move(newTool));
 
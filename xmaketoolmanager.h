@@ -39,10 +39,12 @@ public:
 
     static void notifyAboutUpdate(XMakeTool *);
     static void restoreXMakeTools();
+    static void probeXMakeTools();
 
     static void updateDocumentation();
 
     static QString toolTipForRstHelpFile(const Utils::FilePath &helpFile);
+    static void prewarmRstToolTips(const XMakeKeywords &keywords);
 
     static Utils::FilePath mappedFilePath(const Utils::FilePath &path);
 